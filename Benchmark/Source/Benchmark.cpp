@@ -0,0 +1,345 @@
+#include "Benchmark.h"
+
+namespace benchmark
+{
+	using PID = audio::PID;
+
+	static String toString(Automation a)
+	{
+		switch (a)
+		{
+		case Automation::Static: return "static";
+		case Automation::Sweep: return "sweep";
+		case Automation::Jumps: return "jumps";
+		default: return "";
+		}
+	}
+
+	// Config
+
+	String Config::toString() const
+	{
+		return String(static_cast<int>(sampleRate)) + " Hz, "
+			+ String(blockSize) + " smpls, "
+			+ String(numChannels) + " ch, "
+			+ "HQ " + (hq ? String(1 << hqOrder) + "x " + (hqLowLatency ? "IIR" : "FIR") : String("off")) + ", "
+			+ benchmark::toString(automation);
+	}
+
+	// Result
+
+	String Result::toString() const
+	{
+		return "RTF " + String(realtimeFactor, 1) + "x, "
+			+ "worst block " + String(worstBlockRatio * 100., 1) + "%, "
+			+ String(numAllocations) + " allocs, "
+			+ String(numLocks) + " locks";
+	}
+
+	std::vector<Config> makeMatrix(bool quick)
+	{
+		const std::vector<double> sampleRates = quick ?
+			std::vector<double>{ 48000. } :
+			std::vector<double>{ 44100., 48000., 96000. };
+		const std::vector<int> blockSizes = quick ?
+			std::vector<int>{ 64, 512 } :
+			std::vector<int>{ 16, 64, 256, 1024 };
+		const std::vector<Automation> automations = quick ?
+			std::vector<Automation>{ Automation::Static, Automation::Jumps } :
+			std::vector<Automation>{ Automation::Static, Automation::Sweep, Automation::Jumps };
+#if PPDHasHQ
+		const std::vector<bool> hqs = { false, true };
+		const std::vector<int> hqOrders = quick ?
+			std::vector<int>{ 1, 2 } :
+			std::vector<int>{ 1, 2, 3, 4 };
+		const std::vector<bool> hqLowLatencies = { false, true };
+#else
+		const std::vector<bool> hqs = { false };
+		const std::vector<int> hqOrders = { 1 };
+		const std::vector<bool> hqLowLatencies = { false };
+#endif
+
+		std::vector<Config> matrix;
+		for (auto sampleRate : sampleRates)
+			for (auto blockSize : blockSizes)
+				for (auto numChannels = 1; numChannels <= 2; ++numChannels)
+					for (auto hq : hqs)
+						// the oversampler's settings only matter when it's on
+						for (auto hqOrder : hq ? hqOrders : std::vector<int>{ hqOrders.front() })
+							for (auto hqLowLatency : hq ? hqLowLatencies : std::vector<bool>{ false })
+								for (auto automation : automations)
+									matrix.push_back({ sampleRate, blockSize, numChannels, hq, hqOrder, hqLowLatency, automation });
+		return matrix;
+	}
+
+	// ConvolverCheck
+
+	bool ConvolverCheck::passed() const noexcept
+	{
+		return error <= MaxError;
+	}
+
+	String ConvolverCheck::toString() const
+	{
+		return "convolver, ir " + String(irSize) + " smpls, "
+			+ "error " + String(error, 8) + ", "
+			+ String(nsPerSample, 1) + " ns/smpl "
+			+ (passed() ? "ok" : "FAILED");
+	}
+
+	std::vector<ConvolverCheck> checkConvolver()
+	{
+		static constexpr int NumChannels = 2;
+		static constexpr int NumSamples = 1 << 13;
+		static constexpr int MaxBlockSize = 512;
+		static constexpr int Threshold = audio::Convolver::FFTThreshold;
+
+		const std::vector<int> irSizes = { 1, 64, Threshold - 1, Threshold, Threshold + 1, 1000, 4096 };
+		juce::Random rand(420);
+
+		std::vector<ConvolverCheck> checks;
+		for (auto irSize : irSizes)
+		{
+			std::vector<float> irBuf(irSize);
+			for (auto& x : irBuf)
+				x = rand.nextFloat() * 2.f - 1.f;
+			const audio::ImpulseResponse ir(irBuf);
+
+			juce::AudioBuffer<float> input(NumChannels, NumSamples), output;
+			for (auto ch = 0; ch < NumChannels; ++ch)
+			{
+				auto smpls = input.getWritePointer(ch);
+				for (auto s = 0; s < NumSamples; ++s)
+					smpls[s] = rand.nextFloat() * 2.f - 1.f;
+			}
+			output.makeCopyOf(input);
+
+			audio::WHead wHead;
+			wHead.prepare(MaxBlockSize, irSize);
+			audio::Convolver convolver(ir, wHead);
+			convolver.prepare();
+
+			const auto ticksPerSec = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+			auto ticks = static_cast<juce::int64>(0);
+
+			// uneven blocks, so that they don't line up with the partitions
+			for (auto s = 0; s < NumSamples;)
+			{
+				const auto numSamples = std::min(1 + rand.nextInt(MaxBlockSize), NumSamples - s);
+				float* samples[NumChannels];
+				for (auto ch = 0; ch < NumChannels; ++ch)
+					samples[ch] = output.getWritePointer(ch, s);
+
+				wHead(numSamples);
+				const auto t0 = juce::Time::getHighResolutionTicks();
+				convolver.processBlock(samples, NumChannels, numSamples);
+				ticks += juce::Time::getHighResolutionTicks() - t0;
+				s += numSamples;
+			}
+
+			auto error = 0.;
+			auto peak = 0.;
+			for (auto ch = 0; ch < NumChannels; ++ch)
+			{
+				const auto x = input.getReadPointer(ch);
+				const auto y = output.getReadPointer(ch);
+				for (auto s = 0; s < NumSamples; ++s)
+				{
+					auto direct = 0.;
+					for (auto i = 0; i <= std::min(s, irSize - 1); ++i)
+						direct += static_cast<double>(x[s - i]) * static_cast<double>(ir[i]);
+
+					peak = std::max(peak, std::abs(direct));
+					error = std::max(error, std::abs(direct - static_cast<double>(y[s])));
+				}
+			}
+
+			const auto nsPerSample = static_cast<double>(ticks) / ticksPerSec * 1e9 / static_cast<double>(NumSamples * NumChannels);
+			checks.push_back({ irSize, error / std::max(peak, 1e-9), nsPerSample });
+		}
+		return checks;
+	}
+
+	// PlayHead
+
+	PlayHead::PlayHead() :
+		timeInSamples(0),
+		ppqPosition(0.)
+	{}
+
+	juce::Optional<PlayHead::PositionInfo> PlayHead::getPosition() const
+	{
+		PositionInfo info;
+		info.setBpm(120.);
+		info.setPpqPosition(ppqPosition);
+		info.setTimeInSamples(timeInSamples);
+		info.setIsPlaying(true);
+		return info;
+	}
+
+	void PlayHead::advance(int numSamples, double sampleRate) noexcept
+	{
+		timeInSamples += numSamples;
+		ppqPosition += static_cast<double>(numSamples) / sampleRate * 2.;
+	}
+
+	// Benchmark
+
+	Benchmark::Benchmark(double _lengthInSeconds) :
+		processor(),
+		playHead(),
+		buffer(),
+		noise(2, 1 << 16),
+		midi(),
+		rand(420),
+		lengthInSeconds(_lengthInSeconds)
+	{
+		for (auto ch = 0; ch < noise.getNumChannels(); ++ch)
+		{
+			auto smpls = noise.getWritePointer(ch);
+			for (auto s = 0; s < noise.getNumSamples(); ++s)
+				smpls[s] = (rand.nextFloat() * 2.f - 1.f) * .25f;
+		}
+
+		processor.setPlayHead(&playHead);
+	}
+
+	Result Benchmark::operator()(const Config& config)
+	{
+		prepare(config);
+
+		const auto blockSize = config.blockSize;
+		const auto numBlocks = std::max(1, static_cast<int>(lengthInSeconds * config.sampleRate) / blockSize);
+		const auto blockDuration = static_cast<double>(blockSize) / config.sampleRate;
+		const auto ticksPerSec = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+		auto totalSecs = 0.;
+		auto worstBlockRatio = 0.;
+		auto numAllocations = 0ll;
+		auto numLocks = 0ll;
+		auto readIdx = 0;
+
+		for (auto b = 0; b < numBlocks; ++b)
+		{
+			automate(config.automation, b, numBlocks);
+			fillInput(blockSize, readIdx);
+			midi.clear();
+
+			tripwire::fetchViolations();
+			const auto t0 = juce::Time::getHighResolutionTicks();
+			processor.processBlock(buffer, midi);
+			const auto t1 = juce::Time::getHighResolutionTicks();
+			const auto violations = tripwire::fetchViolations();
+			numAllocations += violations.numAllocations + violations.numDeallocations;
+			numLocks += violations.numLocks;
+
+			const auto secs = static_cast<double>(t1 - t0) / ticksPerSec;
+			totalSecs += secs;
+			worstBlockRatio = std::max(worstBlockRatio, secs / blockDuration);
+			playHead.advance(blockSize, config.sampleRate);
+		}
+
+		return
+		{
+			static_cast<double>(numBlocks) * blockDuration / std::max(totalSecs, 1e-9),
+			worstBlockRatio,
+			numAllocations,
+			numLocks
+		};
+	}
+
+	void Benchmark::prepare(const Config& config)
+	{
+		// no releaseResources in between, it would dump the profile for every config
+		const auto channelSet = config.numChannels == 1 ?
+			juce::AudioChannelSet::mono() :
+			juce::AudioChannelSet::stereo();
+		auto layout = processor.getBusesLayout();
+		layout.inputBuses.getReference(0) = channelSet;
+		layout.outputBuses.getReference(0) = channelSet;
+		processor.setBusesLayout(layout);
+
+		auto& params = processor.params;
+		for (auto i = 0; i < param::NumParams; ++i)
+			if (isAutomatable(static_cast<PID>(i)))
+				params[i]->setValue(params[i]->getDefaultValue());
+		params[PID::Power]->setValue(1.f);
+#if PPDHasHQ
+		params[PID::HQ]->setValue(config.hq ? 1.f : 0.f);
+		params[PID::HQFactor]->setValue(params[PID::HQFactor]->range.convertTo0to1(static_cast<float>(config.hqOrder)));
+		params[PID::HQLowLatency]->setValue(config.hqLowLatency ? 1.f : 0.f);
+#endif
+		// prepareToPlay reads the modulated values
+		processor.macroProcessor();
+
+		processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+		processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+		const auto numChannels = std::max(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+		buffer.setSize(numChannels, config.blockSize, false, true, false);
+		midi.ensureSize(1024);
+		playHead = PlayHead();
+	}
+
+	void Benchmark::automate(Automation automation, int blockIdx, int numBlocks)
+	{
+		auto& params = processor.params;
+
+		switch (automation)
+		{
+		case Automation::Sweep:
+		{
+			// one slow sine per parameter, each with its own phase
+			const auto x = static_cast<float>(blockIdx) / static_cast<float>(numBlocks);
+			for (auto i = 0; i < param::NumParams; ++i)
+				if (isAutomatable(static_cast<PID>(i)))
+				{
+					const auto phase = juce::MathConstants<float>::twoPi * (4.f * x + static_cast<float>(i) * .1f);
+					params[i]->setValue(.5f + .5f * std::sin(phase));
+				}
+			return;
+		}
+		case Automation::Jumps:
+			for (auto i = 0; i < param::NumParams; ++i)
+				if (isAutomatable(static_cast<PID>(i)))
+					params[i]->setValue(rand.nextFloat());
+			return;
+		default:
+			return;
+		}
+	}
+
+	void Benchmark::fillInput(int numSamples, int& readIdx) noexcept
+	{
+		const auto noiseLength = noise.getNumSamples();
+		for (auto ch = 0; ch < buffer.getNumChannels(); ++ch)
+		{
+			const auto src = noise.getReadPointer(ch % noise.getNumChannels());
+			auto dest = buffer.getWritePointer(ch);
+			auto r = readIdx;
+			for (auto s = 0; s < numSamples; ++s)
+			{
+				dest[s] = src[r];
+				r = (r + 1) % noiseLength;
+			}
+		}
+		readIdx = (readIdx + numSamples) % noiseLength;
+	}
+
+	bool Benchmark::isAutomatable(PID pID) const noexcept
+	{
+		// these change the latency, so they are part of the config
+		switch (pID)
+		{
+		case PID::Power:
+#if PPDHasHQ
+		case PID::HQ:
+		case PID::HQFactor:
+		case PID::HQLowLatency:
+#endif
+			return false;
+		default:
+			return true;
+		}
+	}
+}
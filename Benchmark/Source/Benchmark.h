@@ -0,0 +1,116 @@
+#pragma once
+#include "../../Source/Processor.h"
+#include "../../Source/audio/Oversampling.h"
+
+namespace benchmark
+{
+	using String = juce::String;
+	using Processor = audio::Processor;
+
+	enum class Automation
+	{
+		Static,
+		Sweep,
+		Jumps,
+		NumAutomations
+	};
+
+	struct Config
+	{
+		double sampleRate;
+		int blockSize, numChannels;
+		bool hq;
+		// oversampling order (HQFactor) and IIR filters (HQLowLatency), only used with hq
+		int hqOrder;
+		bool hqLowLatency;
+		Automation automation;
+
+		String toString() const;
+	};
+
+	struct Result
+	{
+		/* seconds of audio rendered per second of cpu time */
+		double realtimeFactor;
+		/* slowest block's processing time vs. its duration */
+		double worstBlockRatio;
+		/* heap allocations, deallocations and locks inside processBlock */
+		long long numAllocations, numLocks;
+
+		String toString() const;
+	};
+
+	/* quick */
+	std::vector<Config> makeMatrix(bool);
+
+	struct ConvolverCheck
+	{
+		static constexpr double MaxError = 1e-4;
+
+		int irSize;
+		/* largest difference to direct convolution, relative to its peak */
+		double error;
+		/* processing time per sample and channel */
+		double nsPerSample;
+
+		bool passed() const noexcept;
+
+		String toString() const;
+	};
+
+	/*
+	* runs audio::Convolver against a direct convolution for ir lengths
+	on both sides of its FFTThreshold, with uneven block sizes,
+	and times it.
+	*/
+	std::vector<ConvolverCheck> checkConvolver();
+
+	/*
+	* transport that just moves forward, because processBlock
+	* expects a playhead to be there.
+	*/
+	struct PlayHead :
+		public juce::AudioPlayHead
+	{
+		PlayHead();
+
+		juce::Optional<PositionInfo> getPosition() const override;
+
+		/* numSamples, sampleRate */
+		void advance(int, double) noexcept;
+
+		juce::int64 timeInSamples;
+		double ppqPosition;
+	};
+
+	/*
+	* drives audio::Processor without an editor like a host would.
+	*/
+	struct Benchmark
+	{
+		/* lengthInSeconds */
+		Benchmark(double);
+
+		Result operator()(const Config&);
+
+	protected:
+		Processor processor;
+		PlayHead playHead;
+		juce::AudioBuffer<float> buffer, noise;
+		juce::MidiBuffer midi;
+		juce::Random rand;
+		double lengthInSeconds;
+
+		/* config */
+		void prepare(const Config&);
+
+		/* automation, blockIdx, numBlocks */
+		void automate(Automation, int, int);
+
+		/* numSamples, readIdx */
+		void fillInput(int, int&) noexcept;
+
+		/* pid */
+		bool isAutomatable(audio::PID) const noexcept;
+	};
+}
@@ -0,0 +1,46 @@
+#include "Benchmark.h"
+#include <cstdio>
+
+/*
+* renders audio::Processor offline across a matrix of sample rates,
+* block sizes, channel layouts, HQ (factor, FIR or IIR) and automation patterns.
+*
+* --seconds=n   length of audio per config (default 10)
+* --quick       smaller matrix
+* --strict      exit with 1 if a block missed its deadline, allocated or locked
+*/
+int main(int argc, char* argv[])
+{
+	const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+	const juce::ArgumentList args(argc, argv);
+
+	const auto quick = args.containsOption("--quick");
+	const auto strict = args.containsOption("--strict");
+	auto lengthInSeconds = 10.;
+	if (args.containsOption("--seconds"))
+		lengthInSeconds = std::max(.1, args.getValueForOption("--seconds").getDoubleValue());
+
+	// violations are counted instead
+	tripwire::setAssertEnabled(false);
+
+	benchmark::Benchmark bench(lengthInSeconds);
+	auto failed = false;
+
+	for (const auto& check : benchmark::checkConvolver())
+	{
+		std::printf("%s\n", check.toString().toRawUTF8());
+		if (!check.passed())
+			failed = true;
+	}
+
+	std::printf("%s benchmark, %.1f s per config\n", JucePlugin_Name, lengthInSeconds);
+	for (const auto& config : benchmark::makeMatrix(quick))
+	{
+		const auto result = bench(config);
+		std::printf("%-48s %s\n", config.toString().toRawUTF8(), result.toString().toRawUTF8());
+		if (result.worstBlockRatio > 1. || result.numAllocations != 0 || result.numLocks != 0)
+			failed = true;
+	}
+
+	return strict && failed ? 1 : 0;
+}
@@ -41,6 +41,9 @@ namespace gui
             , &tuningEditor   
 #endif
         ),
+#if PPDHasProfiler
+        profilerComp(utils),
+#endif
 
         contextMenuKnobs(utils),
         contextMenuButtons(utils),
@@ -86,6 +89,10 @@ namespace gui
 
         highLevel.init();
 
+#if PPDHasProfiler
+        addAndMakeVisible(profilerComp);
+#endif
+
         addAndMakeVisible(contextMenuKnobs);
         addAndMakeVisible(contextMenuButtons);
 
@@ -146,6 +153,13 @@ namespace gui
         }
 #endif
 
+#if PPDHasProfiler
+        {
+            const auto bnds = lowLevel.getBounds();
+            profilerComp.setBounds(bnds.withWidth(bnds.getWidth() / 3));
+        }
+#endif
+
         tooltip.setBounds(layout.bottom().toNearestInt());
 
         const auto thicc = utils.thicc;
@@ -9,6 +9,9 @@
 #if PPDHasTuningEditor
 #include "gui/TuningEditor.h"
 #endif
+#if PPDHasProfiler
+#include "gui/ProfilerComp.h"
+#endif
 
 namespace gui
 {
@@ -51,6 +54,9 @@ protected:
         TuningEditor tuningEditor;
 #endif
         HighLevel highLevel;
+#if PPDHasProfiler
+        ProfilerComp profilerComp;
+#endif
 
         ContextMenuKnobs contextMenuKnobs;
         ContextMenuButtons contextMenuButtons;
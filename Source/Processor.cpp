@@ -3,6 +3,12 @@
 
 #include "arch/Conversion.h"
 
+#if PPDHasProfiler
+#define PPDProfile(stage) profiler.mark(Profiler::Stage::stage)
+#else
+#define PPDProfile(stage)
+#endif
+
 namespace audio
 {
     juce::AudioProcessorEditor* Processor::createEditor()
@@ -43,16 +49,20 @@ namespace audio
 #if PPDHasHQ
         oversampler(),
 #endif
-        meters()
+        meters(),
+        latency(0)
 #if PPDHasStereoConfig
         , midSideEnabled(false)
 #endif
 #if PPDHasLookahead
 		, lookaheadEnabled(false)
 #endif
-		, midiVoices(midiManager)
+		, midiVoices()
 #if PPDHasTuningEditor
         , tuningEditorSynth(xenManager)
+#endif
+#if PPDHasProfiler
+        , profiler()
 #endif
     {
         {
@@ -187,11 +197,33 @@ namespace audio
 
     void ProcessorBackEnd::timerCallback()
     {
+#if PPDHasAllocationTripwire
+        {
+            const auto violations = tripwire::fetchViolations();
+            if (violations.numAllocations + violations.numDeallocations + violations.numLocks != 0)
+                DBG("tripwire: " << violations.numAllocations << " allocations (last: "
+                    << static_cast<int>(violations.lastAllocationSize) << " bytes), "
+                    << violations.numDeallocations << " deallocations, "
+                    << violations.numLocks << " locks on the audio thread");
+        }
+#endif
+        {
+            const auto latencyInt = latency.load();
+            if (getLatencySamples() != latencyInt)
+                setLatencySamples(latencyInt);
+        }
+
         bool shallForcePrepare = false;
 #if PPDHasHQ
         const auto ovsrEnabled = params[PID::HQ]->getValMod() > .5f;
         if (oversampler.isEnabled() != ovsrEnabled)
             shallForcePrepare = true;
+        const auto ovsrOrder = static_cast<int>(std::round(params[PID::HQFactor]->getValModDenorm()));
+        if (ovsrEnabled && oversampler.getOrder() != ovsrOrder)
+            shallForcePrepare = true;
+        const auto ovsrLowLatency = params[PID::HQLowLatency]->getValMod() > .5f;
+        if (ovsrEnabled && oversampler.isLowLatency() != ovsrLowLatency)
+            shallForcePrepare = true;
 #endif
 #if PPDHasLookahead
 		const auto _lookaheadEnabled = params[PID::Lookahead]->getValMod() > .5f;
@@ -205,6 +237,16 @@ namespace audio
 		forcePrepareToPlay();
     }
 
+#if PPDHasProfiler
+    bool ProcessorBackEnd::dumpProfile()
+    {
+        auto settings = props.getUserSettings();
+        if (settings == nullptr)
+            return false;
+        return profiler.dump(settings->getFile().getSiblingFile("profile.txt"));
+    }
+
+#endif
     void ProcessorBackEnd::processBlockBypassed(AudioBuffer& buffer, juce::MidiBuffer&)
     {
         macroProcessor();
@@ -214,6 +256,11 @@ namespace audio
 
         if (sus.suspendIfNeeded(mainBuffer))
             return;
+        processBypass(mainBuffer);
+    }
+
+    void ProcessorBackEnd::processBypass(AudioBuffer& mainBuffer) noexcept
+    {
         const auto numSamples = mainBuffer.getNumSamples();
         if (numSamples == 0)
             return;
@@ -233,7 +280,10 @@ namespace audio
 
     Processor::Processor() :
         ProcessorBackEnd(),
+        midiChunk(),
+        midiOut(),
         filter(),
+        filterDesigner(),
         cutoffSmooth(.1f),
         qSmooth(1.f)
 	{
@@ -241,46 +291,109 @@ namespace audio
 
     void Processor::prepareToPlay(double sampleRate, int maxBlockSize)
     {
-        auto latency = 0.f;
-        auto sampleRateUp = sampleRate;
-        auto blockSizeUp = maxBlockSize;
+        // sized for the oversampler's worst case, so that prepareSuspended doesn't allocate
+        auto maxLatency = 0;
+        auto maxBlockSizeUp = maxBlockSize;
 #if PPDHasHQ
-        oversampler.setEnabled(params[PID::HQ]->getValMod() > .5f);
         oversampler.prepare(sampleRate, maxBlockSize);
+        maxLatency = oversampler.getMaxLatency();
+        maxBlockSizeUp = oversampler.getMaxBlockSizeUp();
+#endif
+        const auto sampleRateF = static_cast<float>(sampleRate);
+
+        midiVoices.prepare(maxBlockSizeUp);
+#if PPDHasTuningEditor
+		tuningEditorSynth.prepare(sampleRateF, maxBlockSize);
+#endif
+
+        filter.setNumStages(1);
+        cutoffSmooth.prepare(sampleRateF, maxBlockSizeUp, 20.f);
+		qSmooth.prepare(sampleRateF, maxBlockSizeUp, 20.f);
+
+        dryWetMix.prepare(sampleRateF, maxBlockSize, maxLatency);
+        meters.prepare(sampleRateF, maxBlockSize);
+        midiChunk.ensureSize(2048);
+        midiOut.ensureSize(2048);
+#if PPDHasProfiler
+        profiler.prepare(sampleRate);
+#endif
+        prepareSuspended();
+        setLatencySamples(latency.load());
+    }
+
+    void Processor::prepareSuspended() noexcept
+    {
+        auto sampleRateUp = getSampleRate();
+        auto blockSizeUp = getBlockSize();
+        auto latencyInt = 0;
+#if PPDHasHQ
+        oversampler.setEnabled(params[PID::HQ]->getValMod() > .5f);
+        oversampler.setOrder(static_cast<int>(std::round(params[PID::HQFactor]->getValModDenorm())));
+        oversampler.setLowLatency(params[PID::HQLowLatency]->getValMod() > .5f);
+        oversampler.configure();
         sampleRateUp = oversampler.getFsUp();
         blockSizeUp = oversampler.getBlockSizeUp();
-        latency = static_cast<float>(oversampler.getLatency());
+        latencyInt = oversampler.getLatency();
 #endif
 		
 #if PPDHasLookahead
         lookaheadEnabled = params[PID::Lookahead]->getValMod() > .5f;
 #endif
         const auto sampleRateUpF = static_cast<float>(sampleRateUp);
-        const auto sampleRateF = static_cast<float>(sampleRate);
-
-        midiVoices.prepare(blockSizeUp);
-#if PPDHasTuningEditor
-		tuningEditorSynth.prepare(sampleRateF, maxBlockSize);
-#endif
 
-        filter.resize(2);
-        for (auto& f : filter)
-            f.clear();
+        // within the capacity of prepareToPlay
+        filter.clear();
         cutoffSmooth.prepare(sampleRateUpF, blockSizeUp, 20.f);
 		qSmooth.prepare(sampleRateUpF, blockSizeUp, 20.f);
 
-		const auto latencyInt = static_cast<int>(latency);
-        dryWetMix.prepare(sampleRateF, maxBlockSize, latencyInt);
-        meters.prepare(sampleRateF, maxBlockSize);
-        setLatencySamples(latencyInt);
+        dryWetMix.setLatency(latencyInt);
+        latency.store(latencyInt);
         sus.prepareToPlay();
     }
 
     void Processor::processBlock(AudioBuffer& buffer, MIDIBuffer& midi)
+    {
+#if PPDHasAllocationTripwire
+        const tripwire::ScopedRealtime realtime;
+#endif
+        processChunked(buffer, midi, &Processor::processBlockChunk);
+    }
+
+    void Processor::processChunked(AudioBuffer& buffer, MIDIBuffer& midi, ProcessChunk processChunk) noexcept
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto maxBlockSize = getBlockSize();
+        if (numSamples <= maxBlockSize || maxBlockSize < 1)
+            return (this->*processChunk)(buffer, midi);
+
+        // all buffers are sized in prepareToPlay, so bigger blocks are split up
+        const auto samples = buffer.getArrayOfWritePointers();
+        const auto numChannels = buffer.getNumChannels();
+        midiOut.clear();
+        for (auto s = 0; s < numSamples; s += maxBlockSize)
+        {
+            const auto numSamplesChunk = std::min(maxBlockSize, numSamples - s);
+            AudioBuffer chunk(samples, numChannels, s, numSamplesChunk);
+            midiChunk.clear();
+            midiChunk.addEvents(midi, s, numSamplesChunk, -s);
+            (this->*processChunk)(chunk, midiChunk);
+            // the chunk's midi goes back to where it came from, with whatever was added
+            midiOut.addEvents(midiChunk, 0, numSamplesChunk, s);
+        }
+        midi.clear();
+        midi.addEvents(midiOut, 0, numSamples, 0);
+    }
+
+    void Processor::processBlockChunk(AudioBuffer& buffer, MIDIBuffer& midi) noexcept
     {
         const ScopedNoDenormals noDenormals;
+#if PPDHasProfiler
+        profiler.beginBlock();
+#endif
 
         macroProcessor();
+        PPDProfile(Macro);
+        const auto& snapshot = macroProcessor.snapshot;
 
         auto mainBus = getBus(true, 0);
         auto mainBuffer = mainBus->getBusBuffer(buffer);
@@ -295,15 +408,16 @@ namespace audio
 #if PPDHasTuningEditor
         xenManager
         (
-            std::round(params[PID::Xen]->getValModDenorm()),
-            params[PID::MasterTune]->getValModDenorm(),
-            std::round(params[PID::BaseNote]->getValModDenorm())
+            std::round(snapshot[PID::Xen]),
+            snapshot[PID::MasterTune],
+            std::round(snapshot[PID::BaseNote])
         );
 
 
-        midiVoices.pitchbendRange = std::round(params[PID::PitchbendRange]->getValModDenorm());
+        midiVoices.pitchbendRange = std::round(snapshot[PID::PitchbendRange]);
 #endif	
-        midiManager(midi, numSamples);
+        midiManager(midi, numSamples, midiVoices);
+        PPDProfile(MIDI);
 		
         const auto _playHead = getPlayHead();
         const auto _playHeadPos = _playHead->getPosition();
@@ -317,8 +431,9 @@ namespace audio
 			playHeadPos.timeInSamples = *_playHeadPos->getTimeInSamples();
         }
 
-        if (params[PID::Power]->getValMod() < .5f)
-            return processBlockBypassed(buffer, midi);
+        // the macros and the suspender already ran for this chunk
+        if (snapshot.norm(PID::Power) < .5f)
+            return processBypass(mainBuffer);
 
         const auto samples = mainBuffer.getArrayOfWritePointers();
 #if PPDHasGainIn || PPDHasGainOut
@@ -327,7 +442,7 @@ namespace audio
         const auto numChannels = mainBuffer.getNumChannels();
 
 #if PPD_MixOrGainDry
-        bool muteDry = params[PID::MuteDry]->getValMod() > .5f;
+        bool muteDry = snapshot.norm(PID::MuteDry) > .5f;
 #endif
         dryWetMix.saveDry
         (
@@ -337,28 +452,29 @@ namespace audio
 #if PPDHasGainIn
             params[PID::GainIn]->getValueDenorm(),
 #if PPDHasUnityGain
-            params[PID::UnityGain]->getValMod(),
+            snapshot.norm(PID::UnityGain),
 #endif
 #endif
 #if PPD_MixOrGainDry == 0
-            params[PID::Mix]->getValMod()
+            snapshot.norm(PID::Mix)
 #else
-			, params[PID::Mix]->getValModDenorm()
+			, snapshot[PID::Mix]
 #endif
 #if PPDHasGainOut
-            , params[PID::Gain]->getValModDenorm()
+            , snapshot[PID::Gain]
 #if PPDHasPolarity
-            , (params[PID::Polarity]->getValMod() > .5f ? -1.f : 1.f)
+            , (snapshot.norm(PID::Polarity) > .5f ? -1.f : 1.f)
 #endif
 #endif
         );
+        PPDProfile(SaveDry);
 
 #if PPDHasGainIn
         meters.processIn(constSamples, numChannels, numSamples);
 #endif
 
 #if PPDHasStereoConfig
-        midSideEnabled = numChannels == 2 && params[PID::StereoConfig]->getValMod() > .5f;
+        midSideEnabled = numChannels == 2 && snapshot.norm(PID::StereoConfig) > .5f;
         if (midSideEnabled)
         {
             encodeMS(samples, numSamples, 0);
@@ -366,12 +482,14 @@ namespace audio
             encodeMS(samples, numSamples, 1);
 #endif
         }
-
+        PPDProfile(MidSideEncode);
 #endif
         processBlockPreUpscaled(samples, numChannels, numSamples, midi);
+        PPDProfile(PreUpscaled);
 
 #if PPDHasHQ
         auto resampledBuf = &oversampler.upsample(buffer);
+        PPDProfile(Upsample);
 #else
         auto resampledBuf = &buffer;
 #endif
@@ -408,9 +526,11 @@ namespace audio
             resampledMainBuf.getNumSamples()
         );
 #endif
+        PPDProfile(Upsampled);
 
 #if PPDHasHQ
         oversampler.downsample(mainBuffer);
+        PPDProfile(Downsample);
 #endif
 
 #if PPDHasStereoConfig
@@ -421,16 +541,19 @@ namespace audio
             encodeMS(samples, numSamples, 1);
 #endif
         }
+        PPDProfile(MidSideDecode);
 #endif
 #if PPDHasGainOut
         dryWetMix.processOutGain(samples, numChannels, numSamples);
+        PPDProfile(GainOut);
 #endif
 #if PPDHasTuningEditor
         tuningEditorSynth(samples, numChannels, numSamples);
+        PPDProfile(TuningEditor);
 #endif
 #if PPDHasClipper
         {
-            const auto isClipping = params[PID::Clipper]->getValMod() > .5f ? 1.f : 0.f;
+            const auto isClipping = snapshot.norm(PID::Clipper) > .5f ? 1.f : 0.f;
             if (isClipping)
             {
                 for (auto ch = 0; ch < numChannels; ++ch)
@@ -438,9 +561,11 @@ namespace audio
                         samples[ch][s] = softclip(samples[ch][s], .6f);
             }
         }
+        PPDProfile(Clipper);
 #endif
 #if PPDHasGainOut
         meters.processOut(constSamples, numChannels, numSamples);
+        PPDProfile(Meters);
 #endif
 #if PPD_MixOrGainDry
         if (!muteDry)
@@ -451,9 +576,13 @@ namespace audio
             numChannels,
             numSamples
 #if PPDHasDelta
-            , params[PID::Delta]->getValMod() > .5f
+            , snapshot.norm(PID::Delta) > .5f
 #endif
         );
+        PPDProfile(Mix);
+#if PPDHasProfiler
+        profiler.endBlock(numSamples);
+#endif
 
 #if JUCE_DEBUG
         for (auto ch = 0; ch < numChannels; ++ch)
@@ -472,6 +601,14 @@ namespace audio
     }
 
     void Processor::processBlockBypassed(AudioBuffer& buffer, juce::MidiBuffer& midi)
+    {
+#if PPDHasAllocationTripwire
+        const tripwire::ScopedRealtime realtime;
+#endif
+        processChunked(buffer, midi, &Processor::processBlockBypassedChunk);
+    }
+
+    void Processor::processBlockBypassedChunk(AudioBuffer& buffer, juce::MidiBuffer& midi) noexcept
     {
 		ProcessorBackEnd::processBlockBypassed(buffer, midi);
     }
@@ -487,10 +624,11 @@ namespace audio
 #endif
     ) noexcept
     {
-		const auto cutoffVal = params[PID::FilterCutoff]->getValModDenorm();
-        const auto qVal = params[PID::FilterQ]->getValModDenorm();
+        const auto& snapshot = macroProcessor.snapshot;
+		const auto cutoffVal = snapshot[PID::FilterCutoff];
+        const auto qVal = snapshot[PID::FilterQ];
         
-        const auto upsamplingOrder = static_cast<int>(std::round(params[PID::FilterSmoothUpsampler]->getValModDenorm()));
+        const auto upsamplingOrder = static_cast<int>(std::round(snapshot[PID::FilterSmoothUpsampler]));
         const auto upsamplingFactor = 1 << upsamplingOrder;
         
         const auto cutoffHz = xenManager.noteToFreqHzWithWrap(cutoffVal);
@@ -508,34 +646,27 @@ namespace audio
 			if (!qSmooth.smoothing)
 				SIMD::fill(qBuf, qVal, numSamples);
 
-            for (auto ch = 0; ch < numChannels; ++ch)
+            // coefficients are designed at control rate and ramped in between
+            for (auto s = 0; s < numSamples; s += upsamplingFactor)
             {
-                auto smpls = samples[ch];
-                auto& fltr = filter[ch];
+                const auto numSamplesCtrl = std::min(upsamplingFactor, numSamples - s);
+                const auto sEnd = s + numSamplesCtrl - 1;
 
-                fltr.setFcBP(fcBuf[0], qBuf[0]);
-                smpls[0] = fltr(smpls[0]);
-                
-                for (auto s = 1; s < numSamples; ++s)
-                {
-					if (s % upsamplingFactor == 0)
-						fltr.setFcBP(fcBuf[s], qBuf[s]);
-                    smpls[s] = fltr(smpls[s]);
-                }
+                filterDesigner.setFcBP(fcBuf[sEnd], qBuf[sEnd]);
+                filter.setTarget(0, filterDesigner.getCoefficients());
+                filter(samples, numChannels, s, numSamplesCtrl);
             }
         }
         else
-            for (auto ch = 0; ch < numChannels; ++ch)
-            {
-				auto smpls = samples[ch];
-                auto& fltr = filter[ch];
-                
-                for (auto s = 0; s < numSamples; ++s)
-                    smpls[s] = fltr(smpls[s]);
-            }
+            filter(samples, numChannels, 0, numSamples);
     }
 
-    void Processor::releaseResources() {}
+    void Processor::releaseResources()
+    {
+#if PPDHasProfiler
+        dumpProfile();
+#endif
+    }
 
     /////////////////////////////////////////////
     /////////////////////////////////////////////;
@@ -18,6 +18,11 @@
 #include "audio/AudioUtils.h"
 
 #include "audio/Filter.h"
+#include "audio/BiquadBank.h"
+#if PPDHasProfiler
+#include "audio/Profiler.h"
+#endif
+#include "arch/Tripwire.h"
 
 namespace audio
 {
@@ -26,7 +31,8 @@ namespace audio
 
     struct ProcessorBackEnd :
         public juce::AudioProcessor,
-        public Timer
+        public Timer,
+        public ProcessSuspender::Suspendable
     {
         using ChannelSet = juce::AudioChannelSet;
         using AppProps = juce::ApplicationProperties;
@@ -73,6 +79,15 @@ namespace audio
 #if PPDHasTuningEditor
         TuningEditorSynth tuningEditorSynth;
 #endif
+#if PPDHasProfiler
+        Profiler profiler;
+
+        /* writes the profiler's statistics next to the settings file */
+        bool dumpProfile();
+#endif
+
+        // latency of the last configuration, reported to the host by the timer
+        std::atomic<int> latency;
 
         void forcePrepareToPlay();
 
@@ -80,6 +95,9 @@ namespace audio
 
         void processBlockBypassed(AudioBuffer&, juce::MidiBuffer&) override;
 
+        /* mainBuffer. the bypass itself, after the macros and the suspender ran */
+        void processBypass(AudioBuffer&) noexcept;
+
 #if PPDHasStereoConfig
         bool midSideEnabled;
 #endif
@@ -97,9 +115,22 @@ namespace audio
 
         void prepareToPlay(double, int) override;
 
+        void prepareSuspended() noexcept override;
+
         void processBlock(AudioBuffer&, juce::MidiBuffer&) override;
 
+        /* buffer, midi (numSamples <= prepared block size) */
+        void processBlockChunk(AudioBuffer&, juce::MidiBuffer&) noexcept;
+
         void processBlockBypassed(AudioBuffer&, juce::MidiBuffer&) override;
+
+        /* buffer, midi (numSamples <= prepared block size) */
+        void processBlockBypassedChunk(AudioBuffer&, juce::MidiBuffer&) noexcept;
+
+        using ProcessChunk = void(Processor::*)(AudioBuffer&, juce::MidiBuffer&) noexcept;
+
+        /* buffer, midi, processChunk. splits blocks bigger than the prepared block size */
+        void processChunked(AudioBuffer&, juce::MidiBuffer&, ProcessChunk) noexcept;
         
         /* samples, numChannels, numSamples, midi, samplesSC, numChannelsSC */
         void processBlockPreUpscaled(float* const*, int numChannels, int numSamples, juce::MidiBuffer& midi) noexcept;
@@ -125,7 +156,11 @@ namespace audio
 
         juce::AudioProcessorEditor* createEditor() override;
 
-        std::vector<IIR> filter;
+        // midi of one chunk and of all chunks, if the host exceeds the prepared block size
+        juce::MidiBuffer midiChunk, midiOut;
+
+        BiquadBank filter;
+        IIR filterDesigner;
         PRM cutoffSmooth, qSmooth;
     };
 }
\ No newline at end of file
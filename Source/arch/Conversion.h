@@ -1,5 +1,6 @@
 #pragma once
 #include <juce_core/juce_core.h>
+#include <bit>
 
 namespace audio
 {
@@ -20,6 +21,27 @@ namespace audio
         return numerator / denominator;
     }
 
+    /* x [0, Pi], sinX, cosX
+    (sinApprox's error is below 5e-10 in [-PiHalf, PiHalf], but grows to ~1.5e-5 towards Pi,
+    so both are folded into it. in float that leaves ~2.5e-7, a few ulp) */
+    template <typename Float>
+    inline void sinCosApprox(Float x, Float& sinX, Float& cosX) noexcept
+    {
+        const auto piHalf = static_cast<Float>(1.57079632679489661923);
+        cosX = sinApprox(piHalf - x);
+        sinX = sinApprox(x < piHalf ? x : piHalf * static_cast<Float>(2) - x);
+    }
+
+    /* 2^x without libm, x [-126, 127], relative error ~1e-7 */
+    inline float exp2Approx(float x) noexcept
+    {
+        x = std::min(std::max(x, -126.f), 127.f);
+        const auto xi = static_cast<int>(x + (x < 0.f ? -.5f : .5f));
+        const auto t = (x - static_cast<float>(xi)) * .69314718056f;
+        const auto frac = 1.f + t * (1.f + t * (.5f + t * (.16666666667f + t * (.04166666667f + t * (.00833333333f + t * .00138888889f)))));
+        return frac * std::bit_cast<float>((xi + 127) << 23);
+    }
+
 	template <typename Float>
     inline Float slightlySmaller(Float x) noexcept
     {
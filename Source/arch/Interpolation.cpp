@@ -1,4 +1,5 @@
 #include "Interpolation.h"
+#include "Vec4.h"
 
 namespace interpolate
 {
@@ -32,6 +33,34 @@ namespace interpolate
 		return a + x * (b - a);
 	}
 
+	void lerp(float* dest, const float* samples, const float* phases, float size, int numSamples) noexcept
+	{
+		using Vec4 = simd::Vec4;
+		constexpr auto NumLanes = Vec4::NumLanes;
+		const Vec4 sizeV(size);
+
+		auto s = 0;
+		for (; s + NumLanes <= numSamples; s += NumLanes)
+		{
+			const auto idx = Vec4::load(phases + s) * sizeV;
+			int iF[NumLanes];
+			const auto x = idx - idx.truncate(iF);
+
+			float a[NumLanes], b[NumLanes];
+			for (auto i = 0; i < NumLanes; ++i)
+			{
+				a[i] = samples[iF[i]];
+				b[i] = samples[iF[i] + 1];
+			}
+
+			const auto aV = Vec4::load(a);
+			(aV + x * (Vec4::load(b) - aV)).store(dest + s);
+		}
+
+		for (; s < numSamples; ++s)
+			dest[s] = lerp(samples, phases[s] * size);
+	}
+
 	template<typename T>
 	T cubicHermiteSpline(const T* buffer, T readHead, int size) noexcept
 	{
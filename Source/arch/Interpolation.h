@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <functional>
 
@@ -23,6 +25,10 @@ namespace interpolate
 	template<typename T>
 	T lerp(const T*, T) noexcept;
 
+	/* dest, samples (+1 guard sample), phases [0, 1[, size, numSamples
+	4 samples per simd step, dest may be phases */
+	void lerp(float*, const float*, const float*, float, int) noexcept;
+
 	/* samples, idx, size */
 	template<typename T>
 	T cubicHermiteSpline(const T*, T, int) noexcept;
@@ -31,6 +37,76 @@ namespace interpolate
 	template<typename T>
 	T cubicHermiteSpline(const T*, T) noexcept;
 
+	/*
+	* compile-time selectable interpolators for fractional reads.
+	they never wrap or branch. samples needs NumPre guard samples before
+	index 0 and NumPost after the last one instead, which writeGuarded
+	keeps mirrored. idx [0, size[
+	*/
+
+	struct Lerp
+	{
+		static constexpr int NumPre = 0;
+		static constexpr int NumPost = 1;
+
+		/* samples, i, t [0, 1] */
+		template<typename T>
+		static T read(const T* samples, int i, T t) noexcept
+		{
+			const auto a = samples[i];
+			return a + t * (samples[i + 1] - a);
+		}
+
+		/* samples, idx */
+		template<typename T>
+		static T read(const T* samples, T idx) noexcept
+		{
+			const auto i = static_cast<int>(idx);
+			return read(samples, i, idx - static_cast<T>(i));
+		}
+	};
+
+	struct CubicHermiteSpline
+	{
+		static constexpr int NumPre = 1;
+		static constexpr int NumPost = 2;
+
+		/* samples, i, t [0, 1] */
+		template<typename T>
+		static T read(const T* samples, int i, T t) noexcept
+		{
+			const auto v0 = samples[i - 1];
+			const auto v1 = samples[i];
+			const auto v2 = samples[i + 1];
+			const auto v3 = samples[i + 2];
+
+			const auto c1 = static_cast<T>(.5) * (v2 - v0);
+			const auto c2 = v0 - static_cast<T>(2.5) * v1 + static_cast<T>(2.) * v2 - static_cast<T>(.5) * v3;
+			const auto c3 = static_cast<T>(1.5) * (v1 - v2) + static_cast<T>(.5) * (v3 - v0);
+
+			return ((c3 * t + c2) * t + c1) * t + v1;
+		}
+
+		/* samples, idx */
+		template<typename T>
+		static T read(const T* samples, T idx) noexcept
+		{
+			const auto i = static_cast<int>(idx);
+			return read(samples, i, idx - static_cast<T>(i));
+		}
+	};
+
+	/* samples, size, idx, value. writes the value and mirrors it into the guard samples */
+	template<class Interpolator, typename T>
+	inline void writeGuarded(T* samples, int size, int idx, T value) noexcept
+	{
+		samples[idx] = value;
+		if (idx < Interpolator::NumPost)
+			samples[size + idx] = value;
+		if (idx >= size - Interpolator::NumPre)
+			samples[idx - size] = value;
+	}
+
 	///
 
 	namespace polynomial
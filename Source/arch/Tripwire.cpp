@@ -0,0 +1,228 @@
+#include "Tripwire.h"
+
+#if PPDHasAllocationTripwire
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX && defined(__GLIBC__)
+#define TripwireHooksMalloc 1
+// a plugin's dynamic tls could be allocated lazily, which would recurse into malloc
+#define TripwireTLS __attribute__((tls_model("initial-exec")))
+#elif JUCE_WINDOWS && defined(_DEBUG)
+#define TripwireHooksMalloc 1
+#define TripwireTLS
+#include <crtdbg.h>
+#else
+#define TripwireHooksMalloc 0
+#define TripwireTLS
+#endif
+
+namespace tripwire
+{
+	static thread_local int realtimeDepth TripwireTLS = 0;
+	static std::atomic<long long> numAllocations(0), numDeallocations(0), numLocks(0);
+	static std::atomic<std::size_t> lastAllocationSize(0);
+	static std::atomic<bool> assertEnabled(true);
+
+	static void violation() noexcept
+	{
+		if (!assertEnabled.load(std::memory_order_relaxed))
+			return;
+
+		// the assertion might log and allocate, which must not trip again
+		const auto depth = realtimeDepth;
+		realtimeDepth = 0;
+		jassertfalse;
+		realtimeDepth = depth;
+	}
+
+	static void allocated(std::size_t size) noexcept
+	{
+		if (realtimeDepth == 0)
+			return;
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+		lastAllocationSize.store(size, std::memory_order_relaxed);
+		violation();
+	}
+
+	static void deallocated(void* ptr) noexcept
+	{
+		if (realtimeDepth == 0 || ptr == nullptr)
+			return;
+		numDeallocations.fetch_add(1, std::memory_order_relaxed);
+		violation();
+	}
+
+	ScopedRealtime::ScopedRealtime() noexcept
+	{
+		++realtimeDepth;
+	}
+
+	ScopedRealtime::~ScopedRealtime() noexcept
+	{
+		--realtimeDepth;
+	}
+
+	bool isRealtime() noexcept
+	{
+		return realtimeDepth != 0;
+	}
+
+	void lockTaken() noexcept
+	{
+		if (realtimeDepth == 0)
+			return;
+		numLocks.fetch_add(1, std::memory_order_relaxed);
+		violation();
+	}
+
+	Violations fetchViolations() noexcept
+	{
+		return
+		{
+			numAllocations.exchange(0),
+			numDeallocations.exchange(0),
+			numLocks.exchange(0),
+			lastAllocationSize.load()
+		};
+	}
+
+	void setAssertEnabled(bool e) noexcept
+	{
+		assertEnabled.store(e);
+	}
+
+#if JUCE_WINDOWS && TripwireHooksMalloc
+	// the debug crt reports every heap operation to this hook, operator new included
+	static int allocHook(int allocType, void* ptr, std::size_t size, int blockType,
+		long, const unsigned char*, int)
+	{
+		if (blockType == _CRT_BLOCK)
+			return TRUE;
+		if (allocType == _HOOK_FREE)
+			deallocated(ptr);
+		else
+			allocated(size);
+		return TRUE;
+	}
+
+	[[maybe_unused]] static const auto prevAllocHook = _CrtSetAllocHook(allocHook);
+#endif
+}
+
+#if JUCE_LINUX && TripwireHooksMalloc
+// the plugin's symbols are hidden, so this only replaces its own calls
+extern "C"
+{
+	void* __libc_malloc(std::size_t);
+	void* __libc_calloc(std::size_t, std::size_t);
+	void* __libc_realloc(void*, std::size_t);
+	void __libc_free(void*);
+
+	void* malloc(std::size_t size)
+	{
+		tripwire::allocated(size);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(std::size_t num, std::size_t size)
+	{
+		tripwire::allocated(num * size);
+		return __libc_calloc(num, size);
+	}
+
+	void* realloc(void* ptr, std::size_t size)
+	{
+		tripwire::allocated(size);
+		return __libc_realloc(ptr, size);
+	}
+
+	void free(void* ptr)
+	{
+		tripwire::deallocated(ptr);
+		__libc_free(ptr);
+	}
+}
+#endif
+
+// with malloc hooked, new and delete are counted there
+void* operator new(std::size_t size)
+{
+#if !TripwireHooksMalloc
+	tripwire::allocated(size);
+#endif
+	if (auto ptr = std::malloc(size == 0 ? 1 : size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+#if !TripwireHooksMalloc
+	tripwire::deallocated(ptr);
+#endif
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+// over-aligned types. the block is over-allocated by the counted operator new
+// and the pointer it returned is kept right before the aligned one
+void* operator new(std::size_t size, std::align_val_t al)
+{
+	const auto alignment = static_cast<std::size_t>(al);
+	const auto raw = operator new(size + alignment + sizeof(void*));
+	auto addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+	addr = (addr + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+	const auto ptr = reinterpret_cast<void*>(addr);
+	static_cast<void**>(ptr)[-1] = raw;
+	return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t al)
+{
+	return operator new(size, al);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	if (ptr != nullptr)
+		operator delete(static_cast<void**>(ptr)[-1]);
+}
+
+void operator delete[](void* ptr, std::align_val_t al) noexcept
+{
+	operator delete(ptr, al);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t al) noexcept
+{
+	operator delete(ptr, al);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t al) noexcept
+{
+	operator delete(ptr, al);
+}
+#endif
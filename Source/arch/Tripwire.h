@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+
+#if PPDHasAllocationTripwire
+namespace tripwire
+{
+	/*
+	* marks the calling thread as real-time while in scope.
+	heap allocations and calls to lockTaken on that thread count as
+	violations and assert if asserting is enabled. allocations are caught
+	in the global operator new/delete (the std::align_val_t overloads
+	included) and, with glibc or the windows debug crt, also in malloc,
+	calloc, realloc and free, which is where juce's HeapBlock
+	(AudioBuffer, MidiBuffer..) allocates.
+	what it doesn't see:
+	- malloc & co on macOS and in windows release builds. the default
+	malloc zone belongs to the host and would keep pointing into the plugin
+	after it is unloaded, so it isn't patched. test on linux or a windows
+	debug build to cover HeapBlock.
+	- aligned_alloc, posix_memalign, _aligned_malloc and allocations made
+	inside other shared libraries (the host, system frameworks).
+	- locks. only places that call lockTaken (Param::setValueWithGesture)
+	are counted, mutexes and CriticalSections themselves aren't hooked.
+	*/
+	struct ScopedRealtime
+	{
+		ScopedRealtime() noexcept;
+
+		~ScopedRealtime() noexcept;
+
+		ScopedRealtime(const ScopedRealtime&) = delete;
+		ScopedRealtime& operator=(const ScopedRealtime&) = delete;
+	};
+
+	struct Violations
+	{
+		long long numAllocations, numDeallocations, numLocks;
+		std::size_t lastAllocationSize;
+	};
+
+	bool isRealtime() noexcept;
+
+	/* call where a lock is taken that might block the audio thread */
+	void lockTaken() noexcept;
+
+	/* returns all violations since the last call and resets them */
+	Violations fetchViolations() noexcept;
+
+	/* assert on every violation (default: true) */
+	void setAssertEnabled(bool) noexcept;
+}
+#endif
@@ -0,0 +1,345 @@
+#pragma once
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PPDVec4SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define PPDVec4NEON 1
+#include <arm_neon.h>
+#else
+#include <array>
+#include <cmath>
+#endif
+
+namespace simd
+{
+	/*
+	* 4 floats processed in parallel.
+	uses sse on x86, neon on arm and plain scalars everywhere else.
+	*/
+	struct Vec4
+	{
+		static constexpr int NumLanes = 4;
+
+#if PPDVec4SSE
+		using Native = __m128;
+#elif PPDVec4NEON
+		using Native = float32x4_t;
+#else
+		using Native = std::array<float, NumLanes>;
+#endif
+
+		Vec4() noexcept :
+			v()
+		{}
+
+		Vec4(Native _v) noexcept :
+			v(_v)
+		{}
+
+		/* broadcasts x to all lanes */
+		Vec4(float x) noexcept :
+#if PPDVec4SSE
+			v(_mm_set1_ps(x))
+#elif PPDVec4NEON
+			v(vdupq_n_f32(x))
+#else
+			v({ x, x, x, x })
+#endif
+		{}
+
+		/* reads 4 floats from memory (no alignment needed) */
+		static Vec4 load(const float* src) noexcept
+		{
+#if PPDVec4SSE
+			return _mm_loadu_ps(src);
+#elif PPDVec4NEON
+			return vld1q_f32(src);
+#else
+			return Native({ src[0], src[1], src[2], src[3] });
+#endif
+		}
+
+		/* writes 4 floats to memory (no alignment needed) */
+		void store(float* dest) const noexcept
+		{
+#if PPDVec4SSE
+			_mm_storeu_ps(dest, v);
+#elif PPDVec4NEON
+			vst1q_f32(dest, v);
+#else
+			for (auto i = 0; i < NumLanes; ++i)
+				dest[i] = v[i];
+#endif
+		}
+
+		Vec4 operator+(const Vec4& o) const noexcept
+		{
+#if PPDVec4SSE
+			return _mm_add_ps(v, o.v);
+#elif PPDVec4NEON
+			return vaddq_f32(v, o.v);
+#else
+			return Native({ v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3] });
+#endif
+		}
+
+		Vec4 operator-(const Vec4& o) const noexcept
+		{
+#if PPDVec4SSE
+			return _mm_sub_ps(v, o.v);
+#elif PPDVec4NEON
+			return vsubq_f32(v, o.v);
+#else
+			return Native({ v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3] });
+#endif
+		}
+
+		Vec4 operator*(const Vec4& o) const noexcept
+		{
+#if PPDVec4SSE
+			return _mm_mul_ps(v, o.v);
+#elif PPDVec4NEON
+			return vmulq_f32(v, o.v);
+#else
+			return Native({ v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3] });
+#endif
+		}
+
+		Vec4 operator/(const Vec4& o) const noexcept
+		{
+#if PPDVec4SSE
+			return _mm_div_ps(v, o.v);
+#elif PPDVec4NEON
+			// reciprocal estimate + 2 newton steps
+			auto r = vrecpeq_f32(o.v);
+			r = vmulq_f32(vrecpsq_f32(o.v, r), r);
+			r = vmulq_f32(vrecpsq_f32(o.v, r), r);
+			return vmulq_f32(v, r);
+#else
+			return Native({ v[0] / o.v[0], v[1] / o.v[1], v[2] / o.v[2], v[3] / o.v[3] });
+#endif
+		}
+
+		static Vec4 sqrt(const Vec4& x) noexcept
+		{
+#if PPDVec4SSE
+			return _mm_sqrt_ps(x.v);
+#elif PPDVec4NEON
+			// x * 1/sqrt(x) with 2 newton steps, 0 stays 0
+			auto r = vrsqrteq_f32(x.v);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(x.v, r), r), r);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(x.v, r), r), r);
+			const auto zero = vceqq_f32(x.v, vdupq_n_f32(0.f));
+			return vbslq_f32(zero, x.v, vmulq_f32(x.v, r));
+#else
+			return Native({ std::sqrt(x.v[0]), std::sqrt(x.v[1]), std::sqrt(x.v[2]), std::sqrt(x.v[3]) });
+#endif
+		}
+
+		static Vec4 floor(const Vec4& x) noexcept
+		{
+#if PPDVec4SSE
+			// truncation rounds negative numbers up, so those are corrected by 1
+			const auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+			return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x.v), _mm_set1_ps(1.f)));
+#elif PPDVec4NEON
+			const auto t = vcvtq_f32_s32(vcvtq_s32_f32(x.v));
+			const auto gt = vcgtq_f32(t, x.v);
+			return vsubq_f32(t, vbslq_f32(gt, vdupq_n_f32(1.f), vdupq_n_f32(0.f)));
+#else
+			return Native({ std::floor(x.v[0]), std::floor(x.v[1]), std::floor(x.v[2]), std::floor(x.v[3]) });
+#endif
+		}
+
+		static Vec4 abs(const Vec4& x) noexcept
+		{
+#if PPDVec4SSE
+			// clears the sign bits
+			return _mm_andnot_ps(_mm_set1_ps(-0.f), x.v);
+#elif PPDVec4NEON
+			return vabsq_f32(x.v);
+#else
+			return Native({ std::abs(x.v[0]), std::abs(x.v[1]), std::abs(x.v[2]), std::abs(x.v[3]) });
+#endif
+		}
+
+		static Vec4 max(const Vec4& a, const Vec4& b) noexcept
+		{
+#if PPDVec4SSE
+			return _mm_max_ps(a.v, b.v);
+#elif PPDVec4NEON
+			return vmaxq_f32(a.v, b.v);
+#else
+			return Native({
+				a.v[0] < b.v[0] ? b.v[0] : a.v[0],
+				a.v[1] < b.v[1] ? b.v[1] : a.v[1],
+				a.v[2] < b.v[2] ? b.v[2] : a.v[2],
+				a.v[3] < b.v[3] ? b.v[3] : a.v[3] });
+#endif
+		}
+
+		static Vec4 min(const Vec4& a, const Vec4& b) noexcept
+		{
+#if PPDVec4SSE
+			return _mm_min_ps(a.v, b.v);
+#elif PPDVec4NEON
+			return vminq_f32(a.v, b.v);
+#else
+			return Native({
+				b.v[0] < a.v[0] ? b.v[0] : a.v[0],
+				b.v[1] < a.v[1] ? b.v[1] : a.v[1],
+				b.v[2] < a.v[2] ? b.v[2] : a.v[2],
+				b.v[3] < a.v[3] ? b.v[3] : a.v[3] });
+#endif
+		}
+
+		/* mag, sgn. magnitude of mag with the sign of sgn */
+		static Vec4 copySign(const Vec4& mag, const Vec4& sgn) noexcept
+		{
+#if PPDVec4SSE
+			const auto signBit = _mm_set1_ps(-0.f);
+			return _mm_or_ps(_mm_andnot_ps(signBit, mag.v), _mm_and_ps(signBit, sgn.v));
+#elif PPDVec4NEON
+			return vbslq_f32(vdupq_n_u32(0x80000000), sgn.v, mag.v);
+#else
+			return Native({
+				std::copysign(mag.v[0], sgn.v[0]), std::copysign(mag.v[1], sgn.v[1]),
+				std::copysign(mag.v[2], sgn.v[2]), std::copysign(mag.v[3], sgn.v[3]) });
+#endif
+		}
+
+		/* x [-126, 127], returns 2^x. relative error ~1e-7 */
+		static Vec4 exp2(const Vec4& x) noexcept
+		{
+			const auto xc = min(max(x, Vec4(-126.f)), Vec4(127.f));
+			const auto xr = floor(xc + Vec4(.5f));
+			const auto t = (xc - xr) * Vec4(.69314718056f);
+			// e^t, t [-ln2 / 2, ln2 / 2]
+			const auto frac = Vec4(1.f) + t * (Vec4(1.f) + t * (Vec4(.5f) + t * (Vec4(.16666666667f)
+				+ t * (Vec4(.04166666667f) + t * (Vec4(.00833333333f) + t * Vec4(.00138888889f))))));
+#if PPDVec4SSE
+			const auto e = _mm_add_epi32(_mm_cvttps_epi32(xr.v), _mm_set1_epi32(127));
+			return frac * Vec4(_mm_castsi128_ps(_mm_slli_epi32(e, 23)));
+#elif PPDVec4NEON
+			const auto e = vaddq_s32(vcvtq_s32_f32(xr.v), vdupq_n_s32(127));
+			return frac * Vec4(vreinterpretq_f32_s32(vshlq_n_s32(e, 23)));
+#else
+			return frac * Native({
+				std::ldexp(1.f, static_cast<int>(xr.v[0])), std::ldexp(1.f, static_cast<int>(xr.v[1])),
+				std::ldexp(1.f, static_cast<int>(xr.v[2])), std::ldexp(1.f, static_cast<int>(xr.v[3])) });
+#endif
+		}
+
+		/* x > 0 (normal), returns log2(x). absolute error ~2e-6 */
+		static Vec4 log2(const Vec4& x) noexcept
+		{
+			// x = m * 2^e, m [1, 2[
+#if PPDVec4SSE
+			const auto bits = _mm_castps_si128(x.v);
+			const Vec4 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+			const Vec4 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x7fffff)), _mm_set1_epi32(0x3f800000)));
+#elif PPDVec4NEON
+			const auto bits = vreinterpretq_s32_f32(x.v);
+			const Vec4 e = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+			const Vec4 m = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x7fffff)), vdupq_n_s32(0x3f800000)));
+#else
+			Native eN, mN;
+			for (auto i = 0; i < NumLanes; ++i)
+			{
+				int ei;
+				mN[i] = std::frexp(x.v[i], &ei) * 2.f;
+				eN[i] = static_cast<float>(ei - 1);
+			}
+			const Vec4 e = eN, m = mN;
+#endif
+			// log2(m) = 2 / ln2 * atanh(t), t [0, 1/3[
+			const auto t = (m - Vec4(1.f)) / (m + Vec4(1.f));
+			const auto t2 = t * t;
+			const auto series = t * (Vec4(2.8853900818f) + t2 * (Vec4(.9617966939f) + t2 * (Vec4(.5770780164f)
+				+ t2 * (Vec4(.4121985831f) + t2 * Vec4(.3205988980f)))));
+			return e + series;
+		}
+
+		/* sum of all lanes */
+		float reduceAdd() const noexcept
+		{
+			float lanes[NumLanes];
+			store(lanes);
+			return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		}
+
+		/* maximum of all lanes */
+		float reduceMax() const noexcept
+		{
+			float lanes[NumLanes];
+			store(lanes);
+			const auto a = lanes[0] < lanes[1] ? lanes[1] : lanes[0];
+			const auto b = lanes[2] < lanes[3] ? lanes[3] : lanes[2];
+			return a < b ? b : a;
+		}
+
+		/* dest, writes the lanes truncated towards zero and returns them as floats */
+		Vec4 truncate(int* dest) const noexcept
+		{
+#if PPDVec4SSE
+			const auto i = _mm_cvttps_epi32(v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), i);
+			return _mm_cvtepi32_ps(i);
+#elif PPDVec4NEON
+			const auto i = vcvtq_s32_f32(v);
+			vst1q_s32(dest, i);
+			return vcvtq_f32_s32(i);
+#else
+			Native t;
+			for (auto i = 0; i < NumLanes; ++i)
+			{
+				dest[i] = static_cast<int>(v[i]);
+				t[i] = static_cast<float>(dest[i]);
+			}
+			return t;
+#endif
+		}
+
+		Vec4& operator+=(const Vec4& o) noexcept
+		{
+			*this = *this + o;
+			return *this;
+		}
+
+		Vec4& operator-=(const Vec4& o) noexcept
+		{
+			*this = *this - o;
+			return *this;
+		}
+
+		Vec4& operator*=(const Vec4& o) noexcept
+		{
+			*this = *this * o;
+			return *this;
+		}
+
+		Native v;
+	};
+
+	/* a, b, n. sum of a[i] * b[i], 8 products per step in 2 accumulators */
+	inline float dot(const float* a, const float* b, int n) noexcept
+	{
+		Vec4 acc0(0.f), acc1(0.f);
+		auto i = 0;
+		for (; i + 2 * Vec4::NumLanes <= n; i += 2 * Vec4::NumLanes)
+		{
+			acc0 += Vec4::load(a + i) * Vec4::load(b + i);
+			acc1 += Vec4::load(a + i + Vec4::NumLanes) * Vec4::load(b + i + Vec4::NumLanes);
+		}
+		if (i + Vec4::NumLanes <= n)
+		{
+			acc0 += Vec4::load(a + i) * Vec4::load(b + i);
+			i += Vec4::NumLanes;
+		}
+		auto y = (acc0 + acc1).reduceAdd();
+		for (; i < n; ++i)
+			y += a[i] * b[i];
+		return y;
+	}
+}
@@ -1,17 +1,34 @@
 #include "AutoGain.h"
 #include "AudioUtils.h"
 #include <random>
+#include <map>
+#include <mutex>
 
 namespace audio
 {
 	using MersenneTwister = std::mt19937;
 	using RandDistribution = std::uniform_real_distribution<float>;
+	using File = juce::File;
+	using FileInputStream = juce::FileInputStream;
+	using FileOutputStream = juce::FileOutputStream;
+	using TemporaryFile = juce::TemporaryFile;
 	
 	// PinkNoise
 	
-	PinkNoise::PinkNoise(float targetDb) :
-		noise()
+	PinkNoise::PinkNoise(float _targetDb) :
+		noise(),
+		targetDb(_targetDb),
+		synthesized(false)
 	{
+		noise.fill(0.f);
+	}
+
+	void PinkNoise::synthesize() noexcept
+	{
+		if (synthesized)
+			return;
+		synthesized = true;
+
 		synthesizeWhiteNoise();
 		pinkenNoise();
 
@@ -22,6 +39,11 @@ namespace audio
 			n *= gain;
 	}
 
+	float PinkNoise::getTargetDb() const noexcept
+	{
+		return targetDb;
+	}
+
 	float PinkNoise::rms() noexcept
 	{
 		return getRMS(noise.data(), Size);
@@ -72,11 +94,102 @@ namespace audio
 		}
 	}
 
+	// AutoGain cache
+
+	// gain tables evaluated by any instance in this process
+	struct GainTableCache
+	{
+		std::mutex mutex;
+		std::map<String, std::vector<float>> tables;
+	};
+
+	static GainTableCache& getGainTableCache()
+	{
+		static GainTableCache cache;
+		return cache;
+	}
+
+	/* key */
+	static File getGainTableFile(const String& key)
+	{
+		const auto slash = File::getSeparatorString();
+		const auto specialLoc = File::getSpecialLocation(File::SpecialLocationType::userApplicationDataDirectory);
+
+		return File(specialLoc.getFullPathName() + slash + "Mrugalla" + slash + "SharedState" + slash + "AutoGain"
+			+ slash + String::toHexString(key.hashCode64()) + ".gain");
+	}
+
+	/* key, gain. true if the table was found in memory or on disk */
+	static bool loadGainTable(const String& key, std::vector<float>& gain)
+	{
+		auto& cache = getGainTableCache();
+		const std::lock_guard<std::mutex> lock(cache.mutex);
+
+		const auto it = cache.tables.find(key);
+		if (it != cache.tables.end())
+		{
+			gain = it->second;
+			return true;
+		}
+
+		FileInputStream stream(getGainTableFile(key));
+		if (!stream.openedOk())
+			return false;
+
+		// the file name is only a hash, so the key is stored to rule out collisions
+		const auto numGains = static_cast<int>(gain.size());
+		if (stream.readString() != key || stream.readInt() != numGains)
+			return false;
+		if (stream.getNumBytesRemaining() < numGains * static_cast<int>(sizeof(float)))
+			return false;
+
+		std::vector<float> table(numGains);
+		for (auto& g : table)
+		{
+			g = stream.readFloat();
+			if (std::isnan(g) || std::isinf(g))
+				return false;
+		}
+
+		gain = table;
+		cache.tables[key] = table;
+		return true;
+	}
+
+	/* key, gain */
+	static void saveGainTable(const String& key, const std::vector<float>& gain)
+	{
+		auto& cache = getGainTableCache();
+		const std::lock_guard<std::mutex> lock(cache.mutex);
+		cache.tables[key] = gain;
+
+		const auto file = getGainTableFile(key);
+		if (file.getParentDirectory().createDirectory().failed())
+			return;
+
+		// written next to the target and swapped in, so other processes never read half a table
+		TemporaryFile tmp(file);
+		{
+			FileOutputStream stream(tmp.getFile());
+			if (!stream.openedOk())
+				return;
+			stream.writeString(key);
+			stream.writeInt(static_cast<int>(gain.size()));
+			for (const auto g : gain)
+				stream.writeFloat(g);
+			stream.flush();
+			if (stream.getStatus().failed())
+				return;
+		}
+		tmp.overwriteTargetFileWithTemporary();
+	}
+
 	// AutoGain
 
 	AutoGain::AutoGain(PinkNoise& _noise, const Range& _range, int _numGainSteps) :
 		noise(_noise),
 		range(_range),
+		key(),
 		gain(),
 		numGainStepsF(static_cast<float>(_numGainSteps)),
 		numGainSteps(_numGainSteps),
@@ -88,6 +201,7 @@ namespace audio
 	void AutoGain::evaluate(const OnPrepare& onPrepare,
 		const OnProcess& onProcess, const OnClear& onClear)
 	{
+		noise.synthesize();
 		onPrepare(44100.f, noise.Size);
 		const auto noiseRMS = noise.rms();
 		AudioBuffer buf(1, noise.Size);
@@ -110,36 +224,63 @@ namespace audio
 		evaluating = false;
 	}
 
+	void AutoGain::evaluate(const String& name, int version, std::initializer_list<const AutoGain*> dependencies,
+		const OnPrepare& onPrepare, const OnProcess& onProcess, const OnClear& onClear)
+	{
+		key = String(JucePlugin_Name) + " " + name
+			+ " v" + String(version)
+			+ " range " + String(range.start) + " " + String(range.end) + " " + String(range.interval) + " " + String(range.skew)
+			+ " steps " + String(numGainSteps)
+			+ " noise " + String(noise.getTargetDb());
+		// their gains were applied while rendering, so they are part of this table
+		for (const auto dependency : dependencies)
+			key += " after (" + dependency->key + ")";
+
+		if (loadGainTable(key, gain))
+		{
+			evaluating = false;
+			return;
+		}
+
+		evaluate(onPrepare, onProcess, onClear);
+		saveGainTable(key, gain);
+	}
+
 	float AutoGain::fromDenorm(float smpl, float valPDenorm) const noexcept
+	{
+		return smpl * getGainFromDenorm(valPDenorm);
+	}
+
+	float AutoGain::operator()(float smpl, float valP) const noexcept
+	{
+		return smpl * getGain(valP);
+	}
+
+	float AutoGain::getGainFromDenorm(float valPDenorm) const noexcept
 	{
 		if (evaluating)
-			return smpl;
+			return 1.f;
 
-		return processSample(smpl, range.convertTo0to1(valPDenorm));
+		return interpolateGain(range.convertTo0to1(valPDenorm));
 	}
 
-	float AutoGain::operator()(float smpl, float valP) const noexcept
+	float AutoGain::getGain(float valP) const noexcept
 	{
 		if (evaluating)
-			return smpl;
+			return 1.f;
 
-		return processSample(smpl, valP);
+		return interpolateGain(valP);
 	}
 
-	float AutoGain::processSample(float smpl, float valP) const noexcept
+	float AutoGain::interpolateGain(float valP) const noexcept
 	{
-		const auto mcr = valP;
-		const auto x = mcr * numGainStepsF;
+		const auto x = valP * numGainStepsF;
 		const auto xFloor = std::floor(x);
 		const auto iF = static_cast<int>(xFloor);
 		const auto iC = iF + 1;
 		const auto xFrac = x - xFloor;
 		const auto gF = gain[iF];
 		const auto gC = gain[iC];
-		const auto gRange = gC - gF;
-		const auto g = gF + xFrac * gRange;
-		smpl *= g;
-
-		return smpl;
+		return gF + xFrac * (gC - gF);
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <array>
 #include <functional>
+#include <initializer_list>
 #include "../arch/Range.h"
 
 namespace audio
@@ -9,9 +10,14 @@ namespace audio
 	{
 		static constexpr int Size = 1 << 11;
 		
-		/* targetDb */
+		/* targetDb. the noise is only synthesized when an AutoGain needs it */
 		PinkNoise(float = -24.f);
 
+		/* synthesizes the noise, if it wasn't already */
+		void synthesize() noexcept;
+
+		float getTargetDb() const noexcept;
+
 		float rms() noexcept;
 
 		float* data() noexcept;
@@ -20,6 +26,8 @@ namespace audio
 
 	protected:
 		std::array<float, Size> noise;
+		float targetDb;
+		bool synthesized;
 
 		void synthesizeWhiteNoise() noexcept;
 
@@ -41,22 +49,42 @@ namespace audio
 		void evaluate(const OnPrepare&,
 			const OnProcess&, const OnClear & = []() {});
 
+		/*
+		* name, version, dependencies, onPrepare, onProcess, onClear
+		like evaluate, but the gains are looked up in a table shared by all
+		instances and cached on disk, keyed by product, name, version, range,
+		steps, noise and the keys of the dependencies, which are the autogains
+		already applied while this one is evaluated. only the first instance
+		ever evaluates them, so the version must be raised whenever the
+		module's sound changes.
+		*/
+		void evaluate(const juce::String&, int, std::initializer_list<const AutoGain*>,
+			const OnPrepare&, const OnProcess&, const OnClear & = []() {});
+
 		/* smpl, valPDenorm */
 		float fromDenorm(float, float) const noexcept;
 
 		/* smpl, valP */
 		float operator()(float, float) const noexcept;
 
+		/* valPDenorm, returns the gain (1 while evaluating) */
+		float getGainFromDenorm(float) const noexcept;
+
+		/* valP, returns the gain (1 while evaluating) */
+		float getGain(float) const noexcept;
+
 	protected:
 		PinkNoise& noise;
 		Range range;
+		// identifies the gains in the cache, empty if they weren't cached
+		juce::String key;
 		std::vector<float> gain;
 		float numGainStepsF;
 		int numGainSteps;
 		bool evaluating;
 
-		/* smpl, valP */
-		float processSample(float, float) const noexcept;
+		/* valP */
+		float interpolateGain(float) const noexcept;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "BiquadBank.h"
+
+namespace audio
+{
+	using Vec4 = simd::Vec4;
+
+	/* samples, numChannels, s */
+	static Vec4 gatherLanes(float* const* samples, int numChannels, int s) noexcept
+	{
+		float lanes[Vec4::NumLanes] = { 0.f, 0.f, 0.f, 0.f };
+		for (auto ch = 0; ch < numChannels; ++ch)
+			lanes[ch] = samples[ch][s];
+		return Vec4::load(lanes);
+	}
+
+	/* samples, numChannels, s, y */
+	static void scatterLanes(float* const* samples, int numChannels, int s, const Vec4& y) noexcept
+	{
+		float lanes[Vec4::NumLanes];
+		y.store(lanes);
+		for (auto ch = 0; ch < numChannels; ++ch)
+			samples[ch][s] = lanes[ch];
+	}
+
+	BiquadBank::BiquadBank() :
+		coefs(),
+		coefsDest(),
+		state1(),
+		state2(),
+		numStages(1),
+		ramping(false)
+	{
+		const BiquadCoefficients passThrough{ 1.f, 0.f, 0.f, 0.f, 0.f };
+		coefs.fill(passThrough);
+		coefsDest.fill(passThrough);
+		clear();
+	}
+
+	void BiquadBank::clear() noexcept
+	{
+		state1.fill(0.f);
+		state2.fill(0.f);
+	}
+
+	void BiquadBank::setNumStages(int n) noexcept
+	{
+		numStages = n < 1 ? 1 : n > MaxNumStages ? MaxNumStages : n;
+	}
+
+	void BiquadBank::setCoefficients(int stage, const BiquadCoefficients& c) noexcept
+	{
+		coefs[stage] = c;
+		coefsDest[stage] = c;
+	}
+
+	void BiquadBank::setTarget(int stage, const BiquadCoefficients& c) noexcept
+	{
+		coefsDest[stage] = c;
+		ramping = true;
+	}
+
+	void BiquadBank::operator()(float* const* samples, int numChannels, int startIdx, int numSamples) noexcept
+	{
+		if (numSamples < 1)
+			return;
+		numChannels = numChannels > NumLanes ? NumLanes : numChannels;
+
+		if (ramping)
+		{
+			processRamp(samples, numChannels, startIdx, numSamples);
+			coefs = coefsDest;
+			ramping = false;
+		}
+		else
+			processStatic(samples, numChannels, startIdx, numSamples);
+	}
+
+	void BiquadBank::processStatic(float* const* samples, int numChannels, int startIdx, int numSamples) noexcept
+	{
+		std::array<Coefficients4, MaxNumStages> c;
+		for (auto st = 0; st < numStages; ++st)
+		{
+			const auto& cs = coefs[st];
+			c[st] = { cs.a0, cs.a1, cs.a2, cs.b1, cs.b2 };
+		}
+
+		const auto endIdx = startIdx + numSamples;
+		for (auto s = startIdx; s < endIdx; ++s)
+		{
+			auto x = gatherLanes(samples, numChannels, s);
+
+			for (auto st = 0; st < numStages; ++st)
+			{
+				const auto& cs = c[st];
+				auto& s1 = state1[st];
+				auto& s2 = state2[st];
+
+				const auto y = cs.a0 * x + s1;
+				s1 = cs.a1 * x - cs.b1 * y + s2;
+				s2 = cs.a2 * x - cs.b2 * y;
+				x = y;
+			}
+
+			scatterLanes(samples, numChannels, s, x);
+		}
+	}
+
+	void BiquadBank::processRamp(float* const* samples, int numChannels, int startIdx, int numSamples) noexcept
+	{
+		std::array<Coefficients4, MaxNumStages> c, inc;
+		const auto numSamplesInv = 1.f / static_cast<float>(numSamples);
+		for (auto st = 0; st < numStages; ++st)
+		{
+			const auto& cs = coefs[st];
+			const auto& cd = coefsDest[st];
+			c[st] = { cs.a0, cs.a1, cs.a2, cs.b1, cs.b2 };
+			inc[st] =
+			{
+				(cd.a0 - cs.a0) * numSamplesInv,
+				(cd.a1 - cs.a1) * numSamplesInv,
+				(cd.a2 - cs.a2) * numSamplesInv,
+				(cd.b1 - cs.b1) * numSamplesInv,
+				(cd.b2 - cs.b2) * numSamplesInv
+			};
+		}
+
+		const auto endIdx = startIdx + numSamples;
+		for (auto s = startIdx; s < endIdx; ++s)
+		{
+			auto x = gatherLanes(samples, numChannels, s);
+
+			for (auto st = 0; st < numStages; ++st)
+			{
+				auto& cs = c[st];
+				const auto& ci = inc[st];
+				auto& s1 = state1[st];
+				auto& s2 = state2[st];
+
+				cs.a0 += ci.a0;
+				cs.a1 += ci.a1;
+				cs.a2 += ci.a2;
+				cs.b1 += ci.b1;
+				cs.b2 += ci.b2;
+
+				const auto y = cs.a0 * x + s1;
+				s1 = cs.a1 * x - cs.b1 * y + s2;
+				s2 = cs.a2 * x - cs.b2 * y;
+				x = y;
+			}
+
+			scatterLanes(samples, numChannels, s, x);
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Filter.h"
+#include "../arch/Vec4.h"
+#include <array>
+
+namespace audio
+{
+	/*
+	* cascaded biquads for up to 4 channels, one channel per simd lane.
+	transposed direct form II.
+	new coefficients are reached by a linear ramp over the next
+	processed block, so they only have to be designed at control rate.
+	*/
+	struct BiquadBank
+	{
+		using Vec4 = simd::Vec4;
+		static constexpr int NumLanes = Vec4::NumLanes;
+		static constexpr int MaxNumStages = 8;
+
+		BiquadBank();
+
+		void clear() noexcept;
+
+		/* numStages [1, MaxNumStages] */
+		void setNumStages(int) noexcept;
+
+		/* stage, coefficients (applied immediately) */
+		void setCoefficients(int, const BiquadCoefficients&) noexcept;
+
+		/* stage, coefficients (ramped to across the next block) */
+		void setTarget(int, const BiquadCoefficients&) noexcept;
+
+		/* samples, numChannels [1, NumLanes], startIdx, numSamples */
+		void operator()(float* const*, int, int, int) noexcept;
+
+	protected:
+		struct Coefficients4
+		{
+			Vec4 a0, a1, a2, b1, b2;
+		};
+
+		std::array<BiquadCoefficients, MaxNumStages> coefs, coefsDest;
+		std::array<Vec4, MaxNumStages> state1, state2;
+		int numStages;
+		bool ramping;
+
+		/* samples, numChannels, startIdx, numSamples */
+		void processStatic(float* const*, int, int, int) noexcept;
+
+		/* samples, numChannels, startIdx, numSamples */
+		void processRamp(float* const*, int, int, int) noexcept;
+	};
+}
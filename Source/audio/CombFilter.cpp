@@ -7,48 +7,41 @@ namespace audio
 	
 	CombFilter::DelayFeedback::DelayFeedback() :
 		ringBuffer(),
-		lowpass{ 0.f, 0.f },
-		size(0)
+		lowpass{ 0.f, 0.f }
 	{}
 
 	void CombFilter::DelayFeedback::prepare(float Fs, int _size)
 	{
-		size = _size;
-
-		ringBuffer.setSize(2, size, false, true, false);
+		ringBuffer.prepare(2, _size);
 
 		for (auto& lp : lowpass)
 			lp.makeFromDecayInHz(1000.f, Fs);
 	}
 
 	void CombFilter::DelayFeedback::operator()(float* const* samples, int numChannels, int numSamples,
-		const int* wHead, const float* fbBuf, const float* dampBuf,
-		const float* const* readHead) noexcept
+		const float* fbBuf, const float* dampBuf,
+		const float* const* delay) noexcept
 	{
-		auto ringBuf = ringBuffer.getArrayOfWritePointers();
-
 		for (auto ch = 0; ch < numChannels; ++ch)
 		{
 			auto smpls = samples[ch];
-			auto ring = ringBuf[ch];
-			const auto rHead = readHead[ch];
+			const auto d = delay[ch];
 			auto& lp = lowpass[ch];
 
 			for (auto s = 0; s < numSamples; ++s)
 			{
 				lp.setX(dampBuf[s]);
 
-				const auto w = wHead[s];
-				const auto r = rHead[s];
 				const auto fb = fbBuf[s];
 
-				const auto sOut = lp(interpolate::cubicHermiteSpline(ring, r, size)) * fb + smpls[s];
+				const auto sOut = lp(ringBuffer.read(ch, s, d[s])) * fb + smpls[s];
 				const auto sIn = sOut;
 
-				ring[w] = sIn;
+				ringBuffer.write(ch, s, sIn);
 				smpls[s] = sOut;
 			}
 		}
+		ringBuffer.advance(numSamples);
 	}
 
 	// CombFilter
@@ -57,8 +50,7 @@ namespace audio
 		midiVoices(_midiVoices),
 		xenManager(_xenManager),
 
-		writeHead(),
-		readHeadBuffer(),
+		delayBuffer(),
 		delay(),
 
 		feedbackP(0.f),
@@ -76,8 +68,7 @@ namespace audio
 		sizeF = std::ceil(freqHzInSamples(LowestFrequencyHz, Fs));
 		size = static_cast<int>(sizeF);
 
-		writeHead.prepare(blockSize, size);
-		readHeadBuffer.setSize(2, blockSize, false, false, false);
+		delayBuffer.setSize(2, blockSize, false, false, false);
 		delay.prepare(Fs, size);
 
 		const auto freqHz = xenManager.noteToFreqHzWithWrap(curNote, LowestFrequencyHz);
@@ -91,49 +82,59 @@ namespace audio
 	void CombFilter::operator()(float* const* samples, int numChannels, int numSamples,
 		float _feedback, float _damp, float _retune) noexcept
 	{
-		writeHead(numSamples);
-		const auto wHead = writeHead.data();
-
 		const auto retuneBuf = retuneP(_retune, numSamples);
 
-		{ // calculate readhead indexes from note buffer
-			auto rHeadBuf = readHeadBuffer.getArrayOfWritePointers();
+		{ // calculate delay times from the note and pitchbend runs
+			auto delayBuf = delayBuffer.getArrayOfWritePointers();
 
-			auto& noteBuffer = midiVoices.voices[0].buffer;
+			const auto& notes = midiVoices.voices[0];
+			const auto& pitchbend = midiVoices.pitchbendBuffer;
 
-			for (auto s = 0; s < numSamples; ++s)
+			// both only change at events, so the delay is steady in between unless retune moves
+			auto n = 0, p = 0, s = 0;
+			while (s < numSamples)
 			{
-				auto nNote = static_cast<float>(noteBuffer[0].noteNumber);
-				const auto pb = midiVoices.pitchbendBuffer.buffer[s];
-
-				nNote = juce::jlimit(1.f, 127.f, nNote + retuneBuf[s] + pb);
-
-				if (curNote != nNote)
+				const auto nEnd = notes.getEndIdx(n, numSamples);
+				const auto pEnd = pitchbend.getEndIdx(p, numSamples);
+				const auto endIdx = nEnd < pEnd ? nEnd : pEnd;
+				const auto nNote = static_cast<float>(notes.runs[n].value.noteNumber) + pitchbend.runs[p].value;
+
+				if (retuneP.smoothing)
+					for (; s < endIdx; ++s)
+						delayBuf[0][s] = getDelay(nNote + retuneBuf[s]);
+				else
 				{
-					curNote = nNote;
-					const auto freqHz = xenManager.noteToFreqHzWithWrap(curNote, LowestFrequencyHz);
-					curDelay = freqHzInSamples(freqHz, Fs);
+					SIMD::fill(delayBuf[0] + s, getDelay(nNote + _retune), endIdx - s);
+					s = endIdx;
 				}
 
-				const auto w = static_cast<float>(wHead[s]);
-				auto r = w - curDelay;
-				if (r < 0.f)
-					r += sizeF;
-
-				rHeadBuf[0][s] = r;
+				n += nEnd == endIdx ? 1 : 0;
+				p += pEnd == endIdx ? 1 : 0;
 			}
 
 			for (auto ch = 1; ch < numChannels; ++ch) // only until i have a better idea
-				SIMD::copy(rHeadBuf[ch], rHeadBuf[0], numSamples);
+				SIMD::copy(delayBuf[ch], delayBuf[0], numSamples);
 		}
 
 		const auto fbBuf = feedbackP(_feedback, numSamples);
-		const auto rHeadBufConst = readHeadBuffer.getArrayOfReadPointers();
+		const auto delayBufConst = delayBuffer.getArrayOfReadPointers();
 
 		const auto xFromHz = smooth::Lowpass<float>::getXFromHz(_damp, Fs);
 		const auto dampBuf = dampP(xFromHz, numSamples);
 
 		delay(samples, numChannels, numSamples,
-			wHead, fbBuf, dampBuf, rHeadBufConst);
+			fbBuf, dampBuf, delayBufConst);
+	}
+
+	float CombFilter::getDelay(float nNote) noexcept
+	{
+		nNote = juce::jlimit(1.f, 127.f, nNote);
+		if (curNote != nNote)
+		{
+			curNote = nNote;
+			const auto freqHz = xenManager.noteToFreqHzWithWrap(curNote, LowestFrequencyHz);
+			curDelay = freqHzInSamples(freqHz, Fs);
+		}
+		return curDelay;
 	}
 }
\ No newline at end of file
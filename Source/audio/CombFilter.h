@@ -1,6 +1,6 @@
 #pragma once
 #include <array>
-#include "WHead.h"
+#include "RingBuffer.h"
 #include "AudioUtils.h"
 #include "PRM.h"
 #include "MIDIManager.h"
@@ -13,19 +13,19 @@ namespace audio
 		struct DelayFeedback
 		{
 			using Lowpass = smooth::Lowpass<float>;
+			using Interpolator = interpolate::CubicHermiteSpline;
 
 			DelayFeedback();
 
 			/* Fs, size */
 			void prepare(float, int);
 
-			//samples, numChannels, numSamples, wHead, feedbackBuffer[-1,1], dampBuf, readHead
-			void operator()(float* const*, int, int, const int*, const float*, const float*, const float* const*) noexcept;
+			//samples, numChannels, numSamples, feedbackBuffer[-1,1], dampBuf, delay (samples)
+			void operator()(float* const*, int, int, const float*, const float*, const float* const*) noexcept;
 
 		protected:
-			AudioBuffer ringBuffer;
+			RingBuffer<Interpolator> ringBuffer;
 			std::array<Lowpass, 2> lowpass;
-			int size;
 		};
 
 		static constexpr float LowestFrequencyHz = 20.f;
@@ -43,13 +43,15 @@ namespace audio
 		MIDIVoices& midiVoices;
 		const XenManager& xenManager;
 		
-		WHead writeHead;
-		AudioBuffer readHeadBuffer;
+		AudioBuffer delayBuffer;
 		DelayFeedback delay;
 
 		PRM feedbackP, dampP, retuneP;
 		
 		float Fs, sizeF, curDelay, curNote;
 		int size;
+
+		/* note, returns the delay in samples. only recalculated when the note changed */
+		float getDelay(float) noexcept;
 	};
 }
\ No newline at end of file
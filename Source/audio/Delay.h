@@ -1,6 +1,6 @@
 #pragma once
 #include "AudioUtils.h"
-#include "WHead.h"
+#include "RingBuffer.h"
 #include "Phasor.h"
 
 namespace audio
@@ -14,54 +14,45 @@ namespace audio
 
 		void prepare(int delaySize)
 		{
-			ringBuffer.setSize(2, delaySize, false, true, false);
-		}
-		
-		void operator()(float* smpls, float* ring, int numSamples,
-			const int* wHead, const int* rHead) noexcept
-		{
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				const auto w = wHead[s];
-				const auto r = rHead[s];
-
-				ring[w] = smpls[s];
-				smpls[s] = ring[r];
-			}
+			ringBuffer.prepare(2, delaySize);
 		}
 
-		void operator()(float* smpls, float* ring, int numSamples,
-			const int* wHead, const int* rHead0, const int* rHead1, const PhaseInfo<float>* xFade) noexcept
+		/* samples, numChannels, numSamples, delay */
+		void operator()(float** samples, int numChannels, int numSamples, int delay) noexcept
 		{
-			for (auto s = 0; s < numSamples; ++s)
+			for (auto ch = 0; ch < numChannels; ++ch)
 			{
-				const auto w = wHead[s];
-				const auto r0 = rHead0[s];
-				const auto r1 = rHead1[s];
-				auto xF = xFade[s].phase < 1.f ? xFade[s].phase : 1.f;
-
-				ring[w] = smpls[s];
-				smpls[s] = ring[r0] + xF * (ring[r1] - ring[r0]);
+				auto smpls = samples[ch];
+				for (auto s = 0; s < numSamples; ++s)
+				{
+					ringBuffer.write(ch, s, smpls[s]);
+					smpls[s] = ringBuffer.read(ch, s, delay);
+				}
 			}
+			ringBuffer.advance(numSamples);
 		}
 
+		/* samples, numChannels, numSamples, delay0, delay1, xFade */
 		void operator()(float** samples, int numChannels, int numSamples,
-			const int* wHead, const int* rHead) noexcept
+			int delay0, int delay1, const PhaseInfo<float>* xFade) noexcept
 		{
-			auto ring = ringBuffer.getArrayOfWritePointers();
 			for (auto ch = 0; ch < numChannels; ++ch)
-				operator()(samples[ch], ring[ch], numSamples, wHead, rHead);
-		}
+			{
+				auto smpls = samples[ch];
+				for (auto s = 0; s < numSamples; ++s)
+				{
+					auto xF = xFade[s].phase < 1.f ? xFade[s].phase : 1.f;
 
-		void operator()(float** samples, int numChannels, int numSamples,
-			const int* wHead, const int* rHead0, const int* rHead1, const PhaseInfo<float>* xFade) noexcept
-		{
-			auto ring = ringBuffer.getArrayOfWritePointers();
-			for (auto ch = 0; ch < numChannels; ++ch)
-				operator()(samples[ch], ring[ch], numSamples, wHead, rHead0, rHead1, xFade);
+					ringBuffer.write(ch, s, smpls[s]);
+					const auto y0 = ringBuffer.read(ch, s, delay0);
+					const auto y1 = ringBuffer.read(ch, s, delay1);
+					smpls[s] = y0 + xF * (y1 - y0);
+				}
+			}
+			ringBuffer.advance(numSamples);
 		}
 
-		AudioBuffer ringBuffer;
+		RingBuffer<interpolate::Lerp> ringBuffer;
 	};
 
 	struct DelayFFXFade
@@ -75,8 +66,6 @@ namespace audio
 		
 		DelayFFXFade() :
 			delay(),
-			wHead(),
-			readHeads(),
 			delayPositions{ 0, 0 },
 			delayIdx(0),
 			size(0),
@@ -89,49 +78,31 @@ namespace audio
 		{
 			size = delaySize;
 			delay.prepare(size);
-			wHead.prepare(blockSize, size);
-			for(auto& readHead: readHeads)
-				readHead.resize(blockSize);
 			phasorBuffer.resize(blockSize);
 		}
 
 		void operator()(float** samples, int numChannels, int numSamples,
 			int _nDelayPos, int _grainLength) noexcept
 		{
-			wHead(numSamples);
-			const auto w = wHead.data();
-
 			switch (state)
 			{
 			case State::Running:
-				processRunning(samples, numChannels, numSamples, w, _nDelayPos, _grainLength);
+				processRunning(samples, numChannels, numSamples, _nDelayPos, _grainLength);
 				break;
 			case State::Moving:
-				processMoving(samples, numChannels, numSamples, w);
+				processMoving(samples, numChannels, numSamples);
 				break;
 			}
 		}
 
-		void processRunning(float** samples, int numChannels, int numSamples, 
-			const int* w, int _nDelayPos, int _grainLength) noexcept
+		void processRunning(float** samples, int numChannels, int numSamples,
+			int _nDelayPos, int _grainLength) noexcept
 		{
 			auto curDelayPos = delayPositions[delayIdx];
 			const bool keepRunning = curDelayPos == _nDelayPos;
 
 			if (keepRunning)
-			{
-				auto readHead = readHeads[delayIdx].data();
-
-				for (auto s = 0; s < numSamples; ++s)
-				{
-					auto r = w[s] - curDelayPos;
-					if (r < 0)
-						r += size;
-					readHead[s] = r;
-				}
-
-				delay(samples, numChannels, numSamples, w, readHead);
-			}
+				delay(samples, numChannels, numSamples, curDelayPos);
 			else
 			{
 				delayIdx = 1 - delayIdx;
@@ -139,37 +110,22 @@ namespace audio
 				phasor.reset();
 				phasor.inc = 1.f / static_cast<float>(_grainLength);
 				
-				processMoving(samples, numChannels, numSamples, w);
+				processMoving(samples, numChannels, numSamples);
 			}
 		}
 
-		void processMoving(float** samples, int numChannels, int numSamples,
-			const int* w) noexcept
+		void processMoving(float** samples, int numChannels, int numSamples) noexcept
 		{
 			for (auto s = 0; s < numSamples; ++s)
 				phasorBuffer[s] = phasor();
-			
-			for (auto i = 0; i < 2; ++i)
-			{
-				auto readHead = readHeads[i].data();
-				
-				for (auto s = 0; s < numSamples; ++s)
-				{
-					auto r = w[s] - delayPositions[i];
-					if (r < 0)
-						r += size;
-					readHead[s] = r;
-				}
-			}
 
 			delay
 			(
 				samples,
 				numChannels,
 				numSamples,
-				w,
-				readHeads[1 - delayIdx].data(),
-				readHeads[delayIdx].data(),
+				delayPositions[1 - delayIdx],
+				delayPositions[delayIdx],
 				phasorBuffer.data()
 			);
 
@@ -182,8 +138,6 @@ namespace audio
 		}
 
 		DelayFF delay;
-		WHead wHead;
-		std::array<std::vector<int>, 2> readHeads;
 		std::array<int, 2> delayPositions;
 		int delayIdx, size;
 		State state;
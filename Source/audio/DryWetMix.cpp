@@ -23,9 +23,9 @@ namespace audio
 		gainOutSmoothing(false)
 	{}
 
-	void DryWetMix::prepare(float sampleRate, int blockSize, int latency)
+	void DryWetMix::prepare(float sampleRate, int blockSize, int maxLatency)
 	{
-		latencyCompensation.prepare(blockSize, latency);
+		latencyCompensation.prepare(blockSize, maxLatency);
 
 #if PPDHasGainIn
 		gainInSmooth.makeFromDecayInMs(20.f, sampleRate);
@@ -40,6 +40,11 @@ namespace audio
 		buffers.setSize(NumBufs, blockSize, false, true, false);
 	}
 
+	void DryWetMix::setLatency(int latency) noexcept
+	{
+		latencyCompensation.setLatency(latency);
+	}
+
 	void DryWetMix::saveDry(float* const* samples, int numChannels, int numSamples,
 #if PPDHasGainIn
 		float gainInP,
@@ -21,9 +21,12 @@ namespace audio
 	public:
 		DryWetMix();
 
-		/* sampleRate, blockSize, latency */
+		/* sampleRate, blockSize, maxLatency */
 		void prepare(float, int, int);
 
+		/* latency <= maxLatency. doesn't allocate */
+		void setLatency(int) noexcept;
+
 		/* samples, numChannels, numSamples, gainInP, unityGainP, mixP, gainOutP, polarityP */
 		void saveDry
 		(
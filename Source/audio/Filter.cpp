@@ -1,7 +1,81 @@
 #include "Filter.h"
+#include "../arch/Vec4.h"
+#include <algorithm>
 
 namespace audio
 {
+	// ResponseTable
+
+	ResponseTable::ResponseTable() :
+		cos1(),
+		sin1(),
+		cos2(),
+		sin2()
+	{}
+
+	void ResponseTable::prepare(const float* scaledFreqs, int numFreqs)
+	{
+		cos1.resize(numFreqs);
+		sin1.resize(numFreqs);
+		cos2.resize(numFreqs);
+		sin2.resize(numFreqs);
+
+		for (auto i = 0; i < numFreqs; ++i)
+		{
+			const auto w = Tau * scaledFreqs[i];
+			cos1[i] = std::cos(w);
+			sin1[i] = -std::sin(w);
+			cos2[i] = std::cos(2.f * w);
+			sin2[i] = -std::sin(2.f * w);
+		}
+	}
+
+	const int ResponseTable::size() const noexcept
+	{
+		return static_cast<int>(cos1.size());
+	}
+
+	void multiplyResponse(float* gains, const ResponseTable& table, const BiquadCoefficients& c) noexcept
+	{
+		using Vec4 = simd::Vec4;
+
+		const auto numFreqs = table.size();
+		const auto cos1 = table.cos1.data();
+		const auto sin1 = table.sin1.data();
+		const auto cos2 = table.cos2.data();
+		const auto sin2 = table.sin2.data();
+
+		// |a0 + a1 z + a2 z2| / |1 + b1 z + b2 z2|
+		const Vec4 a0(c.a0), a1(c.a1), a2(c.a2), b1(c.b1), b2(c.b2), one(1.f);
+		auto i = 0;
+		for (; i + Vec4::NumLanes <= numFreqs; i += Vec4::NumLanes)
+		{
+			const auto re1 = Vec4::load(cos1 + i);
+			const auto im1 = Vec4::load(sin1 + i);
+			const auto re2 = Vec4::load(cos2 + i);
+			const auto im2 = Vec4::load(sin2 + i);
+
+			const auto numRe = a0 + a1 * re1 + a2 * re2;
+			const auto numIm = a1 * im1 + a2 * im2;
+			const auto denRe = one + b1 * re1 + b2 * re2;
+			const auto denIm = b1 * im1 + b2 * im2;
+
+			const auto energy = (numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm);
+			(Vec4::load(gains + i) * Vec4::sqrt(energy)).store(gains + i);
+		}
+		for (; i < numFreqs; ++i)
+		{
+			const auto numRe = c.a0 + c.a1 * cos1[i] + c.a2 * cos2[i];
+			const auto numIm = c.a1 * sin1[i] + c.a2 * sin2[i];
+			const auto denRe = 1.f + c.b1 * cos1[i] + c.b2 * cos2[i];
+			const auto denIm = c.b1 * sin1[i] + c.b2 * sin2[i];
+
+			gains[i] *= std::sqrt((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////
+
 	// FilterBandpass (deprecated)
 	
 	FilterBandpass::FilterBandpass(float startVal) :
@@ -50,6 +124,11 @@ namespace audio
 		b2 = other.b2;
 	}
 
+	BiquadCoefficients FilterBandpass::getCoefficients() const noexcept
+	{
+		return { a0, a1, a2, b1, b2 };
+	}
+
 	float FilterBandpass::operator()(float x0) noexcept
 	{
 		return processSample(x0);
@@ -164,6 +243,14 @@ namespace audio
 		return response;
 	}
 	
+	template<size_t NumFilters>
+	void FilterBandpassSlope<NumFilters>::responseGain(float* gains, const ResponseTable& table) const noexcept
+	{
+		std::fill(gains, gains + table.size(), 1.f);
+		for (auto i = 0; i < stage; ++i)
+			multiplyResponse(gains, table, filters[i].getCoefficients());
+	}
+
 	template struct FilterBandpassSlope<1>;
 	template struct FilterBandpassSlope<2>;
 	template struct FilterBandpassSlope<3>;
@@ -177,14 +264,99 @@ namespace audio
 
 	// IIR
 
-	IIR::IIR(float startVal) :
-		alpha(0.f),
-		cosOmega(0.f),
+	BiquadCoefficients IIR::design(Type type, float fc, float q, float gainDb) noexcept
+	{
+		float sinOmega, cosOmega;
+		sinCosApprox(Tau * fc, sinOmega, cosOmega);
+		const auto alpha = sinOmega / (2.f * q);
+		const auto cos2 = -2.f * cosOmega;
+
+		float a0, a1, a2, b0, b1, b2;
+		switch (type)
+		{
+		case Type::LP:
+			a0 = a2 = (1.f - cosOmega) * .5f;
+			a1 = 1.f - cosOmega;
+			b0 = 1.f + alpha;
+			b1 = cos2;
+			b2 = 1.f - alpha;
+			break;
+		case Type::HP:
+			a0 = a2 = (1.f + cosOmega) * .5f;
+			a1 = -1.f - cosOmega;
+			b0 = 1.f + alpha;
+			b1 = cos2;
+			b2 = 1.f - alpha;
+			break;
+		case Type::BP:
+		{
+			const auto makeup = 1.f + q * .5f;
+			a0 = alpha * makeup;
+			a1 = 0.f;
+			a2 = -alpha * makeup;
+			b0 = 1.f + alpha;
+			b1 = cos2;
+			b2 = 1.f - alpha;
+		}
+			break;
+		case Type::BR:
+		case Type::Notch:
+			a0 = a2 = 1.f;
+			a1 = cos2;
+			b0 = 1.f + alpha;
+			b1 = cos2;
+			b2 = 1.f - alpha;
+			break;
+		case Type::AP:
+			a0 = 1.f - alpha;
+			a1 = cos2;
+			a2 = 1.f + alpha;
+			b0 = 1.f + alpha;
+			b1 = cos2;
+			b2 = 1.f - alpha;
+			break;
+		case Type::LS:
+		case Type::HS:
+		{
+			// A = 10^(gainDb / 40)
+			const auto A = exp2Approx(gainDb * .08304820237f);
+			const auto sqrtAlpha = 2.f * std::sqrt(A) * alpha;
+			const auto ap1 = A + 1.f;
+			const auto am1 = A - 1.f;
+			const auto sign = type == Type::LS ? 1.f : -1.f;
+			const auto am1Cos = sign * am1 * cosOmega;
+			a0 = A * (ap1 - am1Cos + sqrtAlpha);
+			a1 = sign * 2.f * A * (am1 - sign * ap1 * cosOmega);
+			a2 = A * (ap1 - am1Cos - sqrtAlpha);
+			b0 = ap1 + am1Cos + sqrtAlpha;
+			b1 = -sign * 2.f * (am1 + sign * ap1 * cosOmega);
+			b2 = ap1 + am1Cos - sqrtAlpha;
+		}
+			break;
+		default: // type == Type::Bell
+		{
+			const auto A = exp2Approx(gainDb * .08304820237f);
+			const auto alphaA = alpha * A;
+			const auto alphaDivA = alpha / A;
+			a0 = 1.f + alphaA;
+			a1 = cos2;
+			a2 = 1.f - alphaA;
+			b0 = 1.f + alphaDivA;
+			b1 = cos2;
+			b2 = 1.f - alphaDivA;
+		}
+			break;
+		}
+
+		const auto b0Inv = 1.f / b0;
+		return { a0 * b0Inv, a1 * b0Inv, a2 * b0Inv, b1 * b0Inv, b2 * b0Inv };
+	}
 
+	IIR::IIR(float startVal) :
 		a0(0.f),
 		a1(0.f),
 		a2(0.f),
-		b0(0.f),
+		b0(1.f),
 		b1(0.f),
 		b2(0.f),
 		x1(0.f),
@@ -203,75 +375,33 @@ namespace audio
 		y2 = 0.f;
 	}
 
-	void IIR::setFc(Type type, float fc, float q) noexcept
+	void IIR::setFc(Type type, float fc, float q, float gainDb) noexcept
 	{
-		switch (type)
-		{
-		case Type::LP: return setFcLP(fc, q);
-		case Type::HP: return setFcHP(fc, q);
-		case Type::BP: return setFcBP(fc, q);
-		case Type::BR: return;
-		case Type::AP: return;
-		case Type::LS: return;
-		case Type::HS: return;
-		case Type::Notch: return;
-		default: return; // type == Type::Bell
-		}
+		setCoefficients(design(type, fc, q, gainDb));
 	}
 
 	void IIR::setFcBP(float fc, float q) noexcept
 	{
-		const auto omega = Tau * fc;
-		cosOmega = -2.f * std::cos(omega);
-		const auto sinOmega = std::sin(omega);
-		alpha = sinOmega / (2.f * q);
-		const auto scale = 1.f + (q / 2.f);
-
-		a0 = alpha * scale;
-		a1 = 0.f;
-		a2 = -alpha * scale;
-
-		b1 = cosOmega;
-		b2 = 1.f - alpha;
-
-		b0 = 1.f + alpha;
-		const auto b0Inv = 1.f / b0;
-
-		a0 *= b0Inv;
-		a1 *= b0Inv;
-		a2 *= b0Inv;
-		b1 *= b0Inv;
-		b2 *= b0Inv;
+		setFc(Type::BP, fc, q);
 	}
 	
-	void IIR::setFcLP(float, float) noexcept
+	void IIR::setFcLP(float fc, float q) noexcept
 	{
-		
+		setFc(Type::LP, fc, q);
 	}
 	
 	void IIR::setFcHP(float fc, float q) noexcept
 	{
-		const auto omega = Tau * fc;
-		cosOmega = -2.f * std::cos(omega);
-		const auto sinOmega = std::sin(omega);
-		alpha = sinOmega / (2.f * q);
-		const auto scale = 1.f + (q / 2.f);
-
-		a0 = (1.f + alpha) * scale;
-		a1 = -2.f * cosOmega * scale;
-		a2 = (1.f - alpha) * scale;
-
-		b1 = -2.f * cosOmega;
-		b2 = 1.f - alpha;
-
-		b0 = 1.f + alpha;
-		const auto b0Inv = 1.f / b0;
+		setFc(Type::HP, fc, q);
+	}
 
-		a0 *= b0Inv;
-		a1 *= b0Inv;
-		a2 *= b0Inv;
-		b1 *= b0Inv;
-		b2 *= b0Inv;
+	void IIR::setCoefficients(const BiquadCoefficients& c) noexcept
+	{
+		a0 = c.a0;
+		a1 = c.a1;
+		a2 = c.a2;
+		b1 = c.b1;
+		b2 = c.b2;
 	}
 
 	void IIR::copy(const IIR& other) noexcept
@@ -284,6 +414,11 @@ namespace audio
 		b2 = other.b2;
 	}
 
+	BiquadCoefficients IIR::getCoefficients() const noexcept
+	{
+		return { a0, a1, a2, b1, b2 };
+	}
+
 	float IIR::operator()(float x0) noexcept
 	{
 		return processSample(x0);
@@ -315,6 +450,12 @@ namespace audio
 		return (a0 + z * a1 + z2 * a2) / (1.f + z * b1 + z2 * b2);
 	}
 
+	void IIR::responseGain(float* gains, const ResponseTable& table) const noexcept
+	{
+		std::fill(gains, gains + table.size(), 1.f);
+		multiplyResponse(gains, table, getCoefficients());
+	}
+
 	float IIR::responseDb(float scaledFreq) const noexcept
 	{
 		auto w = scaledFreq * Tau;
@@ -1,10 +1,38 @@
 #pragma once
 #include "../arch/Conversion.h"
+#include <array>
+#include <vector>
 #include <cmath>
 #include <complex>
 
 namespace audio
 {
+	/* a = feedforward, b = feedback (normalized, so b0 == 1) */
+	struct BiquadCoefficients
+	{
+		float a0, a1, a2, b1, b2;
+	};
+
+	/*
+	* z^-1 and z^-2 on the unit circle for a set of frequencies,
+	so that responses can be evaluated for all of them in one pass.
+	*/
+	struct ResponseTable
+	{
+		ResponseTable();
+
+		/* scaledFreqs [0, .5], numFreqs */
+		void prepare(const float*, int);
+
+		const int size() const noexcept;
+
+		std::vector<float> cos1, sin1, cos2, sin2;
+	};
+
+	/* gains, table, coefs
+	multiplies each gain with the filter's magnitude response at the table's frequency */
+	void multiplyResponse(float*, const ResponseTable&, const BiquadCoefficients&) noexcept;
+
 	struct FilterBandpass
 	{
 		/* startVal */
@@ -17,6 +45,8 @@ namespace audio
 		
 		void copy(const FilterBandpass&) noexcept;
 
+		BiquadCoefficients getCoefficients() const noexcept;
+
 		float operator()(float) noexcept;
 
 		float processSample(float) noexcept;
@@ -53,6 +83,9 @@ namespace audio
 		/* scaledFreq [0, 22050[ */
 		std::complex<float> response(float) const noexcept;
 
+		/* gains, table (cascaded magnitude response of all active stages) */
+		void responseGain(float*, const ResponseTable&) const noexcept;
+
 	protected:
 		std::array<FilterBandpass, NumFilters> filters;
 		int stage;
@@ -76,25 +109,34 @@ namespace audio
 			NumTypes
 		};
 
+		/*
+		* rbj cookbook designs, without libm calls.
+		BP has a makeup gain of 1 + q / 2, BR and Notch are the same filter.
+		type, frequency fc [0, .5[, q-factor q [.1, 160..], gainDb (LS, HS, Bell)
+		*/
+		static BiquadCoefficients design(Type, float, float, float) noexcept;
+
 		/* startVal */
 		IIR(float = 0.f);
 
 		void clear() noexcept;
 
-		/* type, frequency fc [0, .5[, q-factor q [1, 160..] */
-		void setFc(Type, float, float) noexcept;
+		/* type, frequency fc [0, .5[, q-factor q [.1, 160..], gainDb (LS, HS, Bell) */
+		void setFc(Type, float, float, float = 0.f) noexcept;
 
-		/* frequency fc [0, .5[, q-factor q [1, 160..] */
+		/* frequency fc [0, .5[, q-factor q [.1, 160..] */
 		void setFcBP(float, float) noexcept;
 
-		/* frequency fc [0, .5[, q-factor q [1, 160..] */ // doesn't work yet
+		/* frequency fc [0, .5[, q-factor q [.1, 160..] */
 		void setFcLP(float, float) noexcept;
 		
-		/* frequency fc [0, .5[, q-factor q [1, 160..] */ // doesn't work yet
+		/* frequency fc [0, .5[, q-factor q [.1, 160..] */
 		void setFcHP(float, float) noexcept;
 
 		void copy(const IIR&) noexcept;
 
+		BiquadCoefficients getCoefficients() const noexcept;
+
 		float operator()(float) noexcept;
 
 		float processSample(float) noexcept;
@@ -104,9 +146,14 @@ namespace audio
 		/* scaledFreq */
 		float responseDb(float) const noexcept;
 
+		/* gains, table */
+		void responseGain(float*, const ResponseTable&) const noexcept;
+
 	protected:
-		float alpha, cosOmega;
 		float a0, a1, a2, b0, b1, b2;
 		float     x1, x2, y1, y2;
+
+		/* coefs */
+		void setCoefficients(const BiquadCoefficients&) noexcept;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+namespace audio
+{
+	/*
+	* wait-free single-producer single-consumer queue of fixed-size frames,
+	for streaming telemetry from the audio thread to the gui.
+	all slots are preallocated. a frame is only published after it was
+	completely written and only reused after it was released, so the
+	consumer never sees a torn frame. when the queue is full the producer
+	drops the frame instead of waiting.
+	*/
+	template<typename Frame, int Capacity>
+	struct FrameQueue
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of 2");
+		static constexpr unsigned int Mask = Capacity - 1;
+
+		FrameQueue() :
+			slots(),
+			writeIdx(0),
+			readIdx(0)
+		{}
+
+		/* producer. slot to write the next frame into, nullptr if full */
+		Frame* beginWrite() noexcept
+		{
+			const auto w = writeIdx.load(std::memory_order_relaxed);
+			if (w - readIdx.load(std::memory_order_acquire) == Capacity)
+				return nullptr;
+			return &slots[w & Mask];
+		}
+
+		/* producer. publishes the slot from beginWrite */
+		void endWrite() noexcept
+		{
+			writeIdx.store(writeIdx.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		/* frame (producer). false if the queue was full */
+		bool push(const Frame& frame) noexcept
+		{
+			auto slot = beginWrite();
+			if (slot == nullptr)
+				return false;
+			*slot = frame;
+			endWrite();
+			return true;
+		}
+
+		/* consumer. oldest frame, nullptr if empty. release with pop() */
+		const Frame* front() const noexcept
+		{
+			const auto r = readIdx.load(std::memory_order_relaxed);
+			if (writeIdx.load(std::memory_order_acquire) == r)
+				return nullptr;
+			return &slots[r & Mask];
+		}
+
+		/* consumer. newest frame, all older ones are dropped. release with pop() */
+		const Frame* back() noexcept
+		{
+			const auto w = writeIdx.load(std::memory_order_acquire);
+			if (w == readIdx.load(std::memory_order_relaxed))
+				return nullptr;
+			readIdx.store(w - 1, std::memory_order_release);
+			return &slots[(w - 1) & Mask];
+		}
+
+		/* consumer. releases the frame from front() or back() */
+		void pop() noexcept
+		{
+			readIdx.store(readIdx.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		/* frame (consumer). false if empty */
+		bool pop(Frame& frame) noexcept
+		{
+			const auto f = front();
+			if (f == nullptr)
+				return false;
+			frame = *f;
+			pop();
+			return true;
+		}
+
+	protected:
+		std::array<Frame, Capacity> slots;
+		// on separate cache lines, so producer and consumer don't false share
+		alignas(64) std::atomic<unsigned int> writeIdx;
+		alignas(64) std::atomic<unsigned int> readIdx;
+	};
+}
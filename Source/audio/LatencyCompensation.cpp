@@ -15,22 +15,24 @@ namespace audio
 	LatencyCompensation::LatencyCompensation() :
 		ring(),
 		wHead(),
+		blockSize(0),
 		latency(0)
 	{}
 
-	void LatencyCompensation::prepare(int blockSize, int _latency)
+	void LatencyCompensation::prepare(int _blockSize, int maxLatency)
+	{
+		// the ring only ever uses its first latency samples
+		blockSize = _blockSize;
+		ring.setSize(2, maxLatency, false, true, false);
+		wHead.prepare(blockSize, maxLatency);
+		setLatency(latency > maxLatency ? maxLatency : latency);
+	}
+
+	void LatencyCompensation::setLatency(int _latency) noexcept
 	{
 		latency = _latency;
-		if (latency != 0)
-		{
-			ring.setSize(2, latency, false, true, false);
-			wHead.prepare(blockSize, latency);
-		}
-		else
-		{
-			ring.setSize(0, 0);
-			wHead.prepare(0, 0);
-		}
+		ring.clear();
+		wHead.prepare(blockSize, latency);
 	}
 
 	void LatencyCompensation::operator()(float* const* dry, float* const* inputSamples, int numChannels, int numSamples) noexcept
@@ -8,9 +8,12 @@ namespace audio
 	{
 		LatencyCompensation();
 
-		/* blockSize, latency */
+		/* blockSize, maxLatency */
 		void prepare(int, int);
 
+		/* latency <= maxLatency. doesn't allocate */
+		void setLatency(int) noexcept;
+
 		/* dry, inputSamples, numChannels, numSamples */
 		void operator()(float* const*, float* const*, int, int) noexcept;
 
@@ -20,6 +23,7 @@ namespace audio
 	protected:
 		AudioBuffer ring;
 		WHead wHead;
+		int blockSize;
 	public:
 		int latency;
 	};
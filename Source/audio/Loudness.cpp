@@ -0,0 +1,256 @@
+#include "Loudness.h"
+
+namespace audio
+{
+	using Vec4 = simd::Vec4;
+
+	float sumOfSquares(const float* samples, int numSamples) noexcept
+	{
+		Vec4 acc(0.f);
+		auto s = 0;
+		for (; s + Vec4::NumLanes <= numSamples; s += Vec4::NumLanes)
+		{
+			const auto x = Vec4::load(samples + s);
+			acc += x * x;
+		}
+		auto sum = acc.reduceAdd();
+		for (; s < numSamples; ++s)
+			sum += samples[s] * samples[s];
+		return sum;
+	}
+
+	float absMax(const float* samples, int numSamples) noexcept
+	{
+		Vec4 acc(0.f);
+		auto s = 0;
+		for (; s + Vec4::NumLanes <= numSamples; s += Vec4::NumLanes)
+			acc = Vec4::max(acc, Vec4::abs(Vec4::load(samples + s)));
+		auto peak = acc.reduceMax();
+		for (; s < numSamples; ++s)
+		{
+			const auto x = std::abs(samples[s]);
+			peak = peak < x ? x : peak;
+		}
+		return peak;
+	}
+
+	// TruePeak
+
+	/* the interpolation filter's taps, one phase per lane */
+	static std::array<Vec4, TruePeak::NumTaps> makeTruePeakCoefficients() noexcept
+	{
+		static constexpr float Phases[TruePeak::NumPhases][TruePeak::NumTaps] =
+		{
+			{ .0017089843750f, .0109863281250f, -.0196533203125f, .0332031250000f, -.0594482421875f, .1373291015625f,
+				.9721679687500f, -.1022949218750f, .0476074218750f, -.0266113281250f, .0148925781250f, -.0083007812500f },
+			{ -.0291748046875f, .0292968750000f, -.0517578125000f, .0891113281250f, -.1665039062500f, .4650878906250f,
+				.7797851562500f, -.2003173828125f, .1015625000000f, -.0582275390625f, .0330810546875f, -.0189208984375f },
+			{ -.0189208984375f, .0330810546875f, -.0582275390625f, .1015625000000f, -.2003173828125f, .7797851562500f,
+				.4650878906250f, -.1665039062500f, .0891113281250f, -.0517578125000f, .0292968750000f, -.0291748046875f },
+			{ -.0083007812500f, .0148925781250f, -.0266113281250f, .0476074218750f, -.1022949218750f, .9721679687500f,
+				.1373291015625f, -.0594482421875f, .0332031250000f, -.0196533203125f, .0109863281250f, .0017089843750f }
+		};
+
+		std::array<Vec4, TruePeak::NumTaps> coefs;
+		for (auto k = 0; k < TruePeak::NumTaps; ++k)
+		{
+			const float lanes[TruePeak::NumPhases] = { Phases[0][k], Phases[1][k], Phases[2][k], Phases[3][k] };
+			coefs[k] = Vec4::load(lanes);
+		}
+		return coefs;
+	}
+
+	static const std::array<Vec4, TruePeak::NumTaps> TruePeakCoefficients = makeTruePeakCoefficients();
+
+	TruePeak::TruePeak() :
+		history()
+	{
+		clear();
+	}
+
+	void TruePeak::clear() noexcept
+	{
+		for (auto& h : history)
+			h.fill(0.f);
+	}
+
+	float TruePeak::operator()(const float* const* samples, int numChannels, int startIdx, int numSamples) noexcept
+	{
+		numChannels = numChannels > MaxNumChannels ? MaxNumChannels : numChannels;
+		Vec4 peak(0.f);
+
+		for (auto ch = 0; ch < numChannels; ++ch)
+		{
+			const auto x = samples[ch] + startIdx;
+			auto h = history[ch].data();
+
+			// the first samples' taps reach back into the previous call
+			const auto numHead = numSamples < NumHistory ? numSamples : NumHistory;
+			std::copy(x, x + numHead, h + NumHistory);
+			for (auto s = 0; s < numHead; ++s)
+				peak = Vec4::max(peak, Vec4::abs(interpolate(h + NumHistory + s)));
+			for (auto s = numHead; s < numSamples; ++s)
+				peak = Vec4::max(peak, Vec4::abs(interpolate(x + s)));
+
+			if (numSamples >= NumHistory)
+				std::copy(x + numSamples - NumHistory, x + numSamples, h);
+			else
+				std::copy(h + numSamples, h + numSamples + NumHistory, h);
+		}
+
+		return peak.reduceMax();
+	}
+
+	TruePeak::Vec4 TruePeak::interpolate(const float* x) noexcept
+	{
+		auto y = TruePeakCoefficients[0] * Vec4(x[0]);
+		for (auto k = 1; k < NumTaps; ++k)
+			y += TruePeakCoefficients[k] * Vec4(x[-k]);
+		return y;
+	}
+
+	// Loudness
+
+	/* meanSquare */
+	static float toLUFS(float meanSquare) noexcept
+	{
+		return -.691f + 10.f * std::log10(meanSquare + 1e-12f);
+	}
+
+	/* sampleRate, returns the pre-filter (high shelf) and the rlb filter (highpass) */
+	static std::array<BiquadCoefficients, 2> makeKWeighting(float sampleRate) noexcept
+	{
+		// bilinear designs that match the 48khz coefficients of the standard at any rate
+		const auto shelfK = std::tan(static_cast<double>(Pi) * 1681.974450955533 / sampleRate);
+		const auto shelfQ = .7071752369554196;
+		const auto vh = std::pow(10., 3.999843853973347 / 20.);
+		const auto vb = std::pow(vh, .4996667741545416);
+		const auto shelfA0 = 1. + shelfK / shelfQ + shelfK * shelfK;
+
+		const auto hpK = std::tan(static_cast<double>(Pi) * 38.13547087602444 / sampleRate);
+		const auto hpQ = .5003270373238773;
+		const auto hpA0 = 1. + hpK / hpQ + hpK * hpK;
+
+		return
+		{
+			BiquadCoefficients
+			{
+				static_cast<float>((vh + vb * shelfK / shelfQ + shelfK * shelfK) / shelfA0),
+				static_cast<float>(2. * (shelfK * shelfK - vh) / shelfA0),
+				static_cast<float>((vh - vb * shelfK / shelfQ + shelfK * shelfK) / shelfA0),
+				static_cast<float>(2. * (shelfK * shelfK - 1.) / shelfA0),
+				static_cast<float>((1. - shelfK / shelfQ + shelfK * shelfK) / shelfA0)
+			},
+			BiquadCoefficients
+			{
+				1.f,
+				-2.f,
+				1.f,
+				static_cast<float>(2. * (hpK * hpK - 1.) / hpA0),
+				static_cast<float>((1. - hpK / hpQ + hpK * hpK) / hpA0)
+			}
+		};
+	}
+
+	Loudness::Loudness() :
+		kWeighting(),
+		buffer(),
+		blocks(),
+		sum(0.f),
+		blockLenInv(1.f),
+		momentary(toLUFS(0.f)),
+		shortTerm(toLUFS(0.f)),
+		blockLength(1),
+		blockPos(0),
+		blockIdx(0)
+	{
+		blocks.fill(0.f);
+	}
+
+	void Loudness::prepare(float sampleRate, int blockSize)
+	{
+		const auto coefs = makeKWeighting(sampleRate);
+		kWeighting.setNumStages(static_cast<int>(coefs.size()));
+		for (auto st = 0; st < static_cast<int>(coefs.size()); ++st)
+			kWeighting.setCoefficients(st, coefs[st]);
+		kWeighting.clear();
+
+		buffer.setSize(MaxNumChannels, blockSize, false, false, true);
+
+		blockLength = static_cast<int>(std::round(sampleRate * .1f));
+		blockLenInv = 1.f / static_cast<float>(blockLength);
+		blocks.fill(0.f);
+		sum = 0.f;
+		blockPos = 0;
+		blockIdx = 0;
+		momentary = shortTerm = toLUFS(0.f);
+	}
+
+	void Loudness::operator()(const float* const* samples, int numChannels, int numSamples) noexcept
+	{
+		numChannels = numChannels > MaxNumChannels ? MaxNumChannels : numChannels;
+		auto filtered = buffer.getArrayOfWritePointers();
+		const auto maxChunk = buffer.getNumSamples();
+
+		for (auto s = 0; s < numSamples; s += maxChunk)
+		{
+			const auto n = numSamples - s < maxChunk ? numSamples - s : maxChunk;
+			for (auto ch = 0; ch < numChannels; ++ch)
+				SIMD::copy(filtered[ch], samples[ch] + s, n);
+			kWeighting(filtered, numChannels, 0, n);
+			process(filtered, numChannels, n);
+		}
+	}
+
+	float Loudness::getMomentary() const noexcept
+	{
+		return momentary;
+	}
+
+	float Loudness::getShortTerm() const noexcept
+	{
+		return shortTerm;
+	}
+
+	void Loudness::process(float* const* samples, int numChannels, int numSamples) noexcept
+	{
+		// the block boundary splits the buffer, so the reductions run branchless
+		auto s = 0;
+		while (s < numSamples)
+		{
+			const auto remaining = blockLength - blockPos;
+			const auto n = numSamples - s < remaining ? numSamples - s : remaining;
+			for (auto ch = 0; ch < numChannels; ++ch)
+				sum += sumOfSquares(samples[ch] + s, n);
+			s += n;
+			blockPos += n;
+
+			if (blockPos == blockLength)
+			{
+				blocks[blockIdx] = sum * blockLenInv;
+				++blockIdx;
+				blockIdx = blockIdx == NumBlocksShortTerm ? 0 : blockIdx;
+				sum = 0.f;
+				blockPos = 0;
+				updateWindows();
+			}
+		}
+	}
+
+	void Loudness::updateWindows() noexcept
+	{
+		auto sumMomentary = 0.f;
+		for (auto i = 1; i <= NumBlocksMomentary; ++i)
+		{
+			const auto idx = blockIdx - i;
+			sumMomentary += blocks[idx < 0 ? idx + NumBlocksShortTerm : idx];
+		}
+
+		auto sumShortTerm = 0.f;
+		for (const auto b : blocks)
+			sumShortTerm += b;
+
+		momentary = toLUFS(sumMomentary / static_cast<float>(NumBlocksMomentary));
+		shortTerm = toLUFS(sumShortTerm / static_cast<float>(NumBlocksShortTerm));
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "AudioUtils.h"
+#include "BiquadBank.h"
+#include <array>
+
+namespace audio
+{
+	/* samples, numSamples. vectorised sum of squares */
+	float sumOfSquares(const float*, int) noexcept;
+
+	/* samples, numSamples. vectorised maximum magnitude */
+	float absMax(const float*, int) noexcept;
+
+	/*
+	* true peak by 4x oversampling, as in ITU-R BS.1770-4 annex 2.
+	the 48 tap interpolation filter is split into 4 phases of 12 taps,
+	which are evaluated together in the lanes of a Vec4.
+	*/
+	struct TruePeak
+	{
+		using Vec4 = simd::Vec4;
+		static constexpr int NumPhases = Vec4::NumLanes;
+		static constexpr int NumTaps = 12;
+		static constexpr int NumHistory = NumTaps - 1;
+		static constexpr int MaxNumChannels = 4;
+
+		TruePeak();
+
+		void clear() noexcept;
+
+		/* samples, numChannels, startIdx, numSamples. returns the peak magnitude */
+		float operator()(const float* const*, int, int, int) noexcept;
+
+	protected:
+		// the last samples of the previous call, followed by the start of this one
+		std::array<std::array<float, NumHistory * 2>, MaxNumChannels> history;
+
+		/* x, taps are read from x[0] backwards */
+		static Vec4 interpolate(const float*) noexcept;
+	};
+
+	/*
+	* momentary and short-term loudness, as in ITU-R BS.1770-4.
+	the k-weighted mean square is summed over blocks of 100ms,
+	from which the 400ms and 3s windows are updated every block.
+	*/
+	struct Loudness
+	{
+		static constexpr int MaxNumChannels = BiquadBank::NumLanes;
+		static constexpr int NumBlocksMomentary = 4;
+		static constexpr int NumBlocksShortTerm = 30;
+
+		Loudness();
+
+		/* sampleRate, blockSize */
+		void prepare(float, int);
+
+		/* samples, numChannels, numSamples */
+		void operator()(const float* const*, int, int) noexcept;
+
+		/* LUFS of the last 400ms */
+		float getMomentary() const noexcept;
+
+		/* LUFS of the last 3s */
+		float getShortTerm() const noexcept;
+
+	protected:
+		BiquadBank kWeighting;
+		AudioBuffer buffer;
+		std::array<float, NumBlocksShortTerm> blocks;
+		float sum, blockLenInv, momentary, shortTerm;
+		int blockLength, blockPos, blockIdx;
+
+		/* samples, numChannels, numSamples */
+		void process(float* const*, int, int) noexcept;
+
+		void updateWindows() noexcept;
+	};
+}
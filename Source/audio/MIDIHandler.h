@@ -0,0 +1,77 @@
+#pragma once
+#include "AudioUtils.h"
+
+namespace audio
+{
+	/*
+	* base of everything that subscribes to the midi of a block.
+	handlers hide the callbacks they care about and inherit empty ones
+	for the rest. they are resolved at compile time by dispatchMIDI,
+	so unused callbacks cost nothing and none are called indirectly.
+	*/
+	struct MIDIHandler
+	{
+		/* numSamples */
+		void processInit(int) noexcept {}
+
+		/* msg, timestamp */
+		void processNoteOn(const MIDIMessage&, int) noexcept {}
+
+		/* msg, timestamp */
+		void processNoteOff(const MIDIMessage&, int) noexcept {}
+
+		/* msg, timestamp */
+		void processPitchbend(const MIDIMessage&, int) noexcept {}
+
+		/* msg, timestamp */
+		void processCC(const MIDIMessage&, int) noexcept {}
+
+		/* startIdx, endIdx. samples between two event timestamps */
+		void processSpan(int, int) noexcept {}
+
+		/* numSamples */
+		void processEnd(int) noexcept {}
+	};
+
+	/*
+	* midi, numSamples, handlers
+	splits the block at the events' timestamps. each handler gets the
+	events in order and the spans in between as [startIdx, endIdx[,
+	so the cost scales with the number of events instead of samples.
+	*/
+	template<class... Handlers>
+	inline void dispatchMIDI(const MIDIBuffer& midi, int numSamples, Handlers&... handlers) noexcept
+	{
+		(handlers.processInit(numSamples), ...);
+
+		auto startIdx = 0;
+		for (const auto ref : midi)
+		{
+			// events outside of the block are moved to its edges
+			auto ts = ref.samplePosition;
+			ts = ts < startIdx ? startIdx : ts;
+			ts = ts >= numSamples ? numSamples - 1 : ts;
+
+			if (ts > startIdx)
+			{
+				(handlers.processSpan(startIdx, ts), ...);
+				startIdx = ts;
+			}
+
+			const auto msg = ref.getMessage();
+			if (msg.isNoteOn())
+				(handlers.processNoteOn(msg, ts), ...);
+			else if (msg.isNoteOff())
+				(handlers.processNoteOff(msg, ts), ...);
+			else if (msg.isPitchWheel())
+				(handlers.processPitchbend(msg, ts), ...);
+			else if (msg.isController())
+				(handlers.processCC(msg, ts), ...);
+		}
+
+		if (startIdx < numSamples)
+			(handlers.processSpan(startIdx, numSamples), ...);
+
+		(handlers.processEnd(numSamples), ...);
+	}
+}
@@ -54,12 +54,12 @@ namespace audio
 		}
 	}
 
-	void MIDILearn::processBlockInit() noexcept
+	void MIDILearn::processInit(int) noexcept
 	{
 		c = -1;
 	}
 
-	void MIDILearn::processBlockMIDICC(const MIDIMessage& msg) noexcept
+	void MIDILearn::processCC(const MIDIMessage& msg, int) noexcept
 	{
 		c = msg.getControllerNumber();
 		if (c < ccBuf.size())
@@ -77,7 +77,7 @@ namespace audio
 		}
 	}
 
-	void MIDILearn::processBlockEnd() noexcept
+	void MIDILearn::processEnd(int) noexcept
 	{
 		if (c != -1)
 			ccIdx.store(c);
@@ -1,11 +1,12 @@
 #pragma once
 #include <array>
 
-#include "AudioUtils.h"
+#include "MIDIHandler.h"
 
 namespace audio
 {
-	class MIDILearn
+	class MIDILearn :
+		public MIDIHandler
 	{
 		static constexpr float ValInv = 1.f / 128.f;
 
@@ -25,11 +26,14 @@ namespace audio
 		
 		void loadPatch();
 
-		void processBlockInit() noexcept;
+		/* numSamples */
+		void processInit(int) noexcept;
 
-		void processBlockMIDICC(const MIDIMessage& msg) noexcept;
+		/* msg, timestamp */
+		void processCC(const MIDIMessage&, int) noexcept;
 
-		void processBlockEnd() noexcept;
+		/* numSamples */
+		void processEnd(int) noexcept;
 
 		void assignParam(param::Param*) noexcept;
 		
@@ -1,6 +1,5 @@
 #pragma once
 #include "MIDILearn.h"
-#include <functional>
 
 namespace audio
 {
@@ -12,24 +11,14 @@ namespace audio
 
 		void loadPatch();
 
-		/* midiBuffer, numSamples */
-		void operator()(MIDIBuffer&, int) noexcept;
+		/* midiBuffer, numSamples, handlers. midi learn is always dispatched to first */
+		template<class... Handlers>
+		void operator()(const MIDIBuffer& midi, int numSamples, Handlers&... handlers) noexcept
+		{
+			dispatchMIDI(midi, numSamples, midiLearn, handlers...);
+		}
 
 		MIDILearn midiLearn;
-
-		/* numSamples */
-		std::vector<std::function<void(int)>> onInit, onEnd, onSample;
-		/* midiMessage, sampleIndex */
-		std::vector<std::function<void(const MIDIMessage&, int)>> onCC, onNoteOn, onNoteOff, onPitchbend;
-		/* sampleIndex */
-		std::vector<std::function<void(int)>> onNoEvt;
-	protected:
-
-		/* numSamples */
-		void processEmpty(int) noexcept;
-
-		/* midiBuffer, numSamples */
-		void processBlock(MIDIBuffer&, int) noexcept;
 	};
 
 	struct MIDINote
@@ -39,56 +28,123 @@ namespace audio
 		bool noteOn;
 	};
 
-	struct MIDINoteBuffer
+	/*
+	* the values of a block as a list of runs, each lasting until the next
+	one starts. a block without events is a single run, so consumers can
+	skip per-sample work while isConstant(). expand() writes the values
+	out per sample for consumers that need them.
+	*/
+	template<typename T>
+	struct MIDIRunBuffer
+	{
+		struct Run
+		{
+			T value;
+			int startIdx;
+		};
+
+		/* startVal */
+		MIDIRunBuffer(const T& startVal) :
+			runs(),
+			current(startVal)
+		{
+			runs.push_back({ current, 0 });
+		}
+
+		/* blockSize. there can't be more runs than samples */
+		void prepare(int blockSize)
+		{
+			runs.reserve(blockSize + 1);
+		}
+
+		/* starts the block with the last value */
+		void processInit() noexcept
+		{
+			runs.clear();
+			runs.push_back({ current, 0 });
+		}
+
+		/* value, timestamp (ascending) */
+		void set(const T& value, int ts) noexcept
+		{
+			current = value;
+			auto& last = runs.back();
+			if (last.startIdx == ts)
+				last.value = value;
+			else
+				runs.push_back({ value, ts });
+		}
+
+		bool isConstant() const noexcept
+		{
+			return runs.size() == 1;
+		}
+
+		int getNumRuns() const noexcept
+		{
+			return static_cast<int>(runs.size());
+		}
+
+		/* run, numSamples */
+		int getEndIdx(int i, int numSamples) const noexcept
+		{
+			return i + 1 < getNumRuns() ? runs[i + 1].startIdx : numSamples;
+		}
+
+		/* dest, numSamples */
+		void expand(T* dest, int numSamples) const noexcept
+		{
+			for (auto i = 0; i < getNumRuns(); ++i)
+				std::fill(dest + runs[i].startIdx, dest + getEndIdx(i, numSamples), runs[i].value);
+		}
+
+		std::vector<Run> runs;
+		T current;
+	};
+
+	struct MIDINoteBuffer :
+		public MIDIRunBuffer<MIDINote>
 	{
 		MIDINoteBuffer();
 
-		/* blockSize */
-		void prepare(int);
-		
 		/* newNote, timestamp */
 		void processNoteOn(const MIDINote&, int) noexcept;
 
 		/* timestamp */
 		void processNoteOff(int) noexcept;
-
-		/* numSamples */
-		void process(int) noexcept;
-
-		std::vector<MIDINote> buffer;
-		MIDINote curNote;
-		int sampleIdx;
 	};
 
 	using MIDIVoicesArray = std::array<MIDINoteBuffer, PPD_MIDINumVoices>;
 
-	struct MIDIPitchbendBuffer
+	struct MIDIPitchbendBuffer :
+		public MIDIRunBuffer<float>
 	{
 		MIDIPitchbendBuffer();
 
-		/* blockSize */
-		void prepare(int);
-
-		void processInit() noexcept;
-		
 		/* pitchbend, timestamp */
 		void processPitchbend(float, int) noexcept;
-
-		/* numSamples */
-		void process(int) noexcept;
-
-		std::vector<float> buffer;
-		float curPitchbend;
-		int sampleIdx;
 	};
 
-	struct MIDIVoices
+	struct MIDIVoices :
+		public MIDIHandler
 	{
-		MIDIVoices(MIDIManager&);
+		MIDIVoices();
 
 		/* blockSize */
 		void prepare(int);
 
+		/* numSamples */
+		void processInit(int) noexcept;
+
+		/* msg, timestamp */
+		void processNoteOn(const MIDIMessage&, int) noexcept;
+
+		/* msg, timestamp */
+		void processNoteOff(const MIDIMessage&, int) noexcept;
+
+		/* msg, timestamp */
+		void processPitchbend(const MIDIMessage&, int) noexcept;
+
 		MIDIVoicesArray voices;
 		MIDIPitchbendBuffer pitchbendBuffer;
 		float pitchbendRange;
@@ -6,78 +6,103 @@ namespace audio
 	// Manta::Filter
 
 	Manta::Filter::Filter() :
-		filta()
+		bank(),
+		designer(),
+		fcDesigned(0.f),
+		qDesigned(0.f),
+		controlRate(DefaultControlRate),
+		designed(false)
 	{}
 
-	void Manta::Filter::operator()(float* const* laneBuf, float* const* samples, int numChannels, int numSamples,
-		float* fcBuf, float* resoBuf, int stage) noexcept
+	void Manta::Filter::clear() noexcept
 	{
-		{
-			auto lane = laneBuf[0];
-			auto smpls = samples[0];
-			auto& fltr = filta[0];
+		bank.clear();
+		designed = false;
+	}
 
-			fltr.setStage(stage);
+	void Manta::Filter::setControlRate(int r) noexcept
+	{
+		controlRate = r < 1 ? 1 : r;
+	}
 
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				fltr.setFc(fcBuf[s], resoBuf[s]);
-				lane[s] = fltr(smpls[s]);
-			}
+	void Manta::Filter::operator()(float* const* laneBuf, int numChannels, int numSamples,
+		const float* fcBuf, const float* resoBuf, float fc, float q, int stage) noexcept
+	{
+		bank.setNumStages(stage);
+
+		if (!designed)
+		{
+			design(fcBuf != nullptr ? fcBuf[0] : fc, resoBuf != nullptr ? resoBuf[0] : q, false);
+			designed = true;
 		}
 
-		for (auto ch = 1; ch < numChannels; ++ch)
+		// smoothing has settled, so at most one ramp to the targets
+		if (fcBuf == nullptr && resoBuf == nullptr)
 		{
-			auto lane = laneBuf[ch];
-			auto smpls = samples[ch];
-			auto& fltr = filta[ch];
+			if (fc != fcDesigned || q != qDesigned)
+				design(fc, q, true);
+			return bank(laneBuf, numChannels, 0, numSamples);
+		}
 
-			fltr.setStage(stage);
+		for (auto s = 0; s < numSamples; s += controlRate)
+		{
+			const auto numSamplesCtrl = std::min(controlRate, numSamples - s);
+			const auto sEnd = s + numSamplesCtrl - 1;
 
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				fltr.setFc(fcBuf[s], resoBuf[s]);
-				lane[s] = fltr(smpls[s]);
-			}
+			const auto fcCtrl = fcBuf != nullptr ? fcBuf[sEnd] : fc;
+			const auto qCtrl = resoBuf != nullptr ? resoBuf[sEnd] : q;
+			if (fcCtrl != fcDesigned || qCtrl != qDesigned)
+				design(fcCtrl, qCtrl, true);
+
+			bank(laneBuf, numChannels, s, numSamplesCtrl);
 		}
 	}
 
+	void Manta::Filter::design(float fc, float q, bool ramp) noexcept
+	{
+		fcDesigned = fc;
+		qDesigned = q;
+		designer.setFc(fc, q);
+		const auto coefs = designer.getCoefficients();
+
+		// all stages of the slope share the same coefficients
+		for (auto st = 0; st < MaxSlopeStage; ++st)
+			if (ramp)
+				bank.setTarget(st, coefs);
+			else
+				bank.setCoefficients(st, coefs);
+	}
+
 	// Manta::DelayFeedback
 
 	Manta::DelayFeedback::DelayFeedback() :
-		ringBuffer(),
-		size(0)
+		ringBuffer()
 	{}
 
 	void Manta::DelayFeedback::prepare(int delaySize)
 	{
-		size = delaySize;
-		ringBuffer.setSize(2, size, false, true, false);
+		ringBuffer.prepare(2, delaySize);
 	}
 
-	void Manta::DelayFeedback::operator()(float* const* samples, int numChannels, int numSamples, const int* wHead, const float* rHead,
-		const float* feedback) noexcept
+	void Manta::DelayFeedback::operator()(float* const* samples, int numChannels, int numSamples,
+		const float* delay, const float* feedback) noexcept
 	{
-		auto ringBuffr = ringBuffer.getArrayOfWritePointers();
-
 		for (auto ch = 0; ch < numChannels; ++ch)
 		{
 			auto smpls = samples[ch];
-			auto ring = ringBuffr[ch];
 
 			for (auto s = 0; s < numSamples; ++s)
 			{
-				const auto w = wHead[s];
-				const auto r = rHead[s];
 				const auto fb = feedback[s];
 
-				const auto sOut = interpolate::lerp(ring, r, size) * fb + smpls[s];
+				const auto sOut = ringBuffer.read(ch, s, delay[s]) * fb + smpls[s];
 				const auto sIn = sOut;
 
-				ring[w] = sIn;
+				ringBuffer.write(ch, s, sIn);
 				smpls[s] = sOut;
 			}
 		}
+		ringBuffer.advance(numSamples);
 	}
 
 	// Manta::RingMod
@@ -85,12 +110,14 @@ namespace audio
 	Manta::RingMod::RingMod() :
 		waveTable(),
 		phasor(),
-		oscBuffer()
+		oscBuffer(),
+		phaseBuffer(),
+		incBuffer()
 	{
 		createWavetable([](float x) { return std::cos(x * Pi); });
 	}
 
-	void Manta::RingMod::createWavetable(const WTFunc& func) noexcept
+	void Manta::RingMod::createWavetable(const WTFunc& func)
 	{
 		waveTable.create(func);
 	}
@@ -99,18 +126,15 @@ namespace audio
 	{
 		phasor.prepare(1.f / Fs);
 		oscBuffer.resize(blockSize, 0.f);
+		phaseBuffer.resize(blockSize, 0.f);
+		incBuffer.resize(blockSize, 0.f);
 	}
 
 	void Manta::RingMod::operator()(float* const* samples, int numChannels, int numSamples,
 		float* _rmDepth, float* _freqHz) noexcept
 	{
-		for (auto s = 0; s < numSamples; ++s)
-		{
-			const auto freqHz = _freqHz[s];
-			phasor.setFrequencyHz(freqHz);
-			auto p = phasor().phase;
-			oscBuffer[s] = waveTable(p);
-		}
+		phasor(phaseBuffer.data(), incBuffer.data(), _freqHz, numSamples);
+		waveTable(oscBuffer.data(), phaseBuffer.data(), incBuffer.data(), numSamples);
 
 		for (auto ch = 0; ch < numChannels; ++ch)
 		{
@@ -134,7 +158,6 @@ namespace audio
 	Manta::Lane::Lane() :
 		ringMod(),
 		laneBuffer(),
-		readHead(),
 		filter(),
 
 		frequency(.5f),
@@ -148,8 +171,7 @@ namespace audio
 
 		delayFB(),
 
-		Fs(1.f),
-		delaySizeF(1.f)
+		Fs(1.f)
 	{}
 
 	void Manta::Lane::prepare(float sampleRate, int blockSize, int delaySize)
@@ -167,16 +189,20 @@ namespace audio
 		rmDepth.prepare(Fs, blockSize, 10.f);
 		rmFreqHz.prepare(Fs, blockSize, 10.f);
 		delayFB.prepare(delaySize);
-		readHead.resize(blockSize, 0.f);
 		ringMod.prepare(Fs, blockSize);
 
-		delaySizeF = static_cast<float>(delaySize);
+		filter.clear();
+	}
+
+	void Manta::Lane::setControlRate(int r) noexcept
+	{
+		filter.setControlRate(r);
 	}
 
 	void Manta::Lane::operator()(float* const* samples, int numChannels, int numSamples,
 		bool enabled, float _pitch, float _resonance, int _slope, float _drive, float _feedback,
 		float _oct, float _semi, float _rmOct, float _rmSemi, float _rmDepth, float _gain,
-		const int* wHead, const XenManager& xen) noexcept
+		const XenManager& xen) noexcept
 	{
 		auto lane = laneBuffer.getArrayOfWritePointers();
 
@@ -192,13 +218,17 @@ namespace audio
 
 		const auto freqHz = xen.noteToFreqHzWithWrap(_pitch, 20.f);
 
-		const auto fcBuf = frequency(freqHzInFc(freqHz, Fs), numSamples);
+		const auto fc = freqHzInFc(freqHz, Fs);
+		const auto fcBuf = frequency(fc, numSamples);
 		const auto resoBuf = resonance(_resonance, numSamples);
 
+		// the buffers only get written while smoothing
 		filter
 		(
-			lane, samples, numChannels, numSamples,
-			fcBuf, resoBuf, _slope
+			lane, numChannels, numSamples,
+			frequency.smoothing ? fcBuf : nullptr,
+			resonance.smoothing ? resoBuf : nullptr,
+			fc, _resonance, _slope
 		);
 
 		const auto xenVal = xen.getXen();
@@ -208,8 +238,7 @@ namespace audio
 		const auto delayFreqHz = xen.noteToFreqHzWithWrap(delayPitch, 5.f);
 		const auto delaySamples = freqHzInSamples(delayFreqHz, Fs);
 		const auto delayRateBuf = delayRate(delaySamples, numSamples);
-		const auto rHead = getRHead(numSamples, wHead, delayRateBuf);
-		delayFB(lane, numChannels, numSamples, wHead, rHead, feedbackBuf);
+		delayFB(lane, numChannels, numSamples, delayRateBuf, feedbackBuf);
 
 		const auto driveBuf = drive(_drive, numSamples);
 		distort(lane, numChannels, numSamples, driveBuf);
@@ -243,21 +272,6 @@ namespace audio
 	}
 
 	
-	const float* Manta::Lane::getRHead(int numSamples, const int* wHead, const float* delayBuf) noexcept
-	{
-		auto rHead = readHead.data();
-		for (auto s = 0; s < numSamples; ++s)
-		{
-			const auto w = static_cast<float>(wHead[s]);
-			auto r = w - delayBuf[s];
-			if (r < 0.f)
-				r += delaySizeF;
-
-			rHead[s] = r;
-		}
-		return rHead;
-	}
-
 	float Manta::Lane::distort(float x, float d) const noexcept
 	{
 		auto w = std::tanh(256.f * x) / 256.f;
@@ -286,11 +300,15 @@ namespace audio
 	Manta::Manta(const XenManager& _xen) :
 		xen(_xen),
 		lanes(),
-		writeHead(),
+		laneParams(),
+		workerPool(),
+		blockSamples(nullptr),
+		blockNumChannels(0),
+		blockNumSamples(0),
 		delaySize(1)
 	{}
 
-	void Manta::prepare(float sampleRate, int blockSize)
+	void Manta::prepare(float sampleRate, int blockSize, bool parallel)
 	{
 		delaySize = static_cast<int>(std::ceil(freqHzInSamples(static_cast<float>(5.f), sampleRate)) + 3.f);
 		if (delaySize % 2 != 0)
@@ -299,7 +317,18 @@ namespace audio
 		for (auto& lane : lanes)
 			lane.prepare(sampleRate, blockSize, delaySize);
 
-		writeHead.prepare(blockSize, delaySize);
+		// the coefficients keep their rate in time, not in samples
+		const auto rateScale = sampleRate / 44100.f;
+		setControlRate(static_cast<int>(std::round(static_cast<float>(Filter::DefaultControlRate) * rateScale)));
+
+		// the calling thread processes one of the lanes itself
+		workerPool.prepare(parallel && blockSize >= MinParallelBlockSize ? NumLanes - 1 : 0);
+	}
+
+	void Manta::setControlRate(int r) noexcept
+	{
+		for (auto& lane : lanes)
+			lane.setControlRate(r);
 	}
 
 	void Manta::operator()(float* const* samples, int numChannels, int numSamples,
@@ -307,61 +336,56 @@ namespace audio
 		bool l2Enabled, bool l2Snap, float l2Pitch, float l2Resonance, int l2Slope, float l2Drive, float l2Feedback, float l2Oct, float l2Semi, float l2RMOct, float l2RMSemi, float l2RMDepth, float l2Gain,
 		bool l3Enabled, bool l3Snap, float l3Pitch, float l3Resonance, int l3Slope, float l3Drive, float l3Feedback, float l3Oct, float l3Semi, float l3RMOct, float l3RMSemi, float l3RMDepth, float l3Gain) noexcept
 	{
-		bool enabled[NumLanes] = { l1Enabled, l2Enabled, l3Enabled };
-		float pitch[NumLanes] =
-		{
-			l1Snap ? std::rint(l1Pitch) : l1Pitch,
-			l2Snap ? std::rint(l2Pitch) : l2Pitch,
-			l3Snap ? std::rint(l3Pitch) : l3Pitch
-		};
-		float resonance[NumLanes] = { l1Resonance, l2Resonance, l3Resonance };
-		int slope[NumLanes] = { l1Slope, l2Slope, l3Slope };
-		float drive[NumLanes] = { l1Drive, l2Drive, l3Drive };
-		float feedback[NumLanes] = { l1Feedback, l2Feedback, l3Feedback };
-		float oct[NumLanes] = { l1Oct, l2Oct, l3Oct };
-		float semi[NumLanes] = { l1Semi, l2Semi, l3Semi };
-		float rmOct[NumLanes] = { l1RMOct, l2RMOct, l3RMOct };
-		float rmSemi[NumLanes] = { l1RMSemi, l2RMSemi, l3RMSemi };
-		float rmDepth[NumLanes] = { l1RMDepth, l2RMDepth, l3RMDepth };
-		float gain[NumLanes] = { l1Gain, l2Gain, l3Gain };
-
-		writeHead(numSamples);
-		const auto wHead = writeHead.data();
-
-		for (auto i = 0; i < NumLanes; ++i)
-		{
-			auto& lane = lanes[i];
-
-			lane
-			(
-				samples,
-				numChannels,
-				numSamples,
-
-				enabled[i],
-				pitch[i],
-				resonance[i],
-				slope[i],
-				drive[i],
-				feedback[i],
-				oct[i],
-				semi[i],
-				rmOct[i],
-				rmSemi[i],
-				rmDepth[i],
-				gain[i],
-
-				wHead,
-				xen
-			);
-		}
-
+		laneParams[0] = { l1Enabled, l1Snap ? std::rint(l1Pitch) : l1Pitch, l1Resonance, l1Slope, l1Drive, l1Feedback, l1Oct, l1Semi, l1RMOct, l1RMSemi, l1RMDepth, l1Gain };
+		laneParams[1] = { l2Enabled, l2Snap ? std::rint(l2Pitch) : l2Pitch, l2Resonance, l2Slope, l2Drive, l2Feedback, l2Oct, l2Semi, l2RMOct, l2RMSemi, l2RMDepth, l2Gain };
+		laneParams[2] = { l3Enabled, l3Snap ? std::rint(l3Pitch) : l3Pitch, l3Resonance, l3Slope, l3Drive, l3Feedback, l3Oct, l3Semi, l3RMOct, l3RMSemi, l3RMDepth, l3Gain };
+
+		blockSamples = samples;
+		blockNumChannels = numChannels;
+		blockNumSamples = numSamples;
+
+		// the lanes only share read-only data until they are summed
+		if (numSamples >= MinParallelBlockSize)
+			workerPool.run(&processLane, this, NumLanes);
+		else
+			for (auto i = 0; i < NumLanes; ++i)
+				processLane(this, i);
+
+		// summed in lane order, so the result doesn't depend on the threads
 		for (auto ch = 0; ch < numChannels; ++ch)
 			SIMD::clear(samples[ch], numSamples);
 		for (auto& lane : lanes)
 			lane.addTo(samples, numChannels, numSamples);
 	}
 
+	void Manta::processLane(void* context, int i) noexcept
+	{
+		auto& manta = *static_cast<Manta*>(context);
+		const auto& p = manta.laneParams[i];
+
+		manta.lanes[i]
+		(
+			manta.blockSamples,
+			manta.blockNumChannels,
+			manta.blockNumSamples,
+
+			p.enabled,
+			p.pitch,
+			p.resonance,
+			p.slope,
+			p.drive,
+			p.feedback,
+			p.oct,
+			p.semi,
+			p.rmOct,
+			p.rmSemi,
+			p.rmDepth,
+			p.gain,
+
+			manta.xen
+		);
+	}
+
 	void Manta::savePatch(sta::State& state)
 	{
 		for (auto l = 0; l < NumLanes; ++l)
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Filter.h"
+#include "BiquadBank.h"
 #include "PRM.h"
 #include "Phasor.h"
 #include "WaveTable.h"
 #include "XenManager.h"
-#include "WHead.h"
+#include "RingBuffer.h"
+#include "WorkerPool.h"
+#include "../arch/Interpolation.h"
 
 namespace audio
 {
@@ -16,34 +19,57 @@ namespace audio
 		static constexpr int WaveTableSize = 1 << 13; // around min 5hz
 		static constexpr int NumLanes = 3;
 		static constexpr int MaxSlopeStage = 4; //4*12db/oct
+		static constexpr int MinParallelBlockSize = 256;
 		using WT = WaveTable<WaveTableSize>;
 	private:
+		/*
+		* cascaded bandpass with both channels in one biquad bank.
+		coefficients are designed at control rate and only if
+		cutoff or resonance changed. the bank ramps in between.
+		*/
 		class Filter
 		{
-			using Fltr = FilterBandpassSlope<MaxSlopeStage>;
 		public:
+			static constexpr int DefaultControlRate = 16;
+
 			Filter();
 
-			/* laneBuf, samples, numChannels, numSamples, fcBuf, resoBuf, stage */
-			void operator()(float* const*, float* const*, int, int,
-				float*, float*, int) noexcept;
+			void clear() noexcept;
+
+			/* controlRate [1, N] samples */
+			void setControlRate(int) noexcept;
+
+			/*
+			* laneBuf, numChannels, numSamples, fcBuf, resoBuf, fc, q, stage
+			a buffer is nullptr if its PRM isn't smoothing, then fc or q is used
+			*/
+			void operator()(float* const*, int, int,
+				const float*, const float*, float, float, int) noexcept;
 
 		protected:
-			std::array<Fltr, 2> filta;
+			BiquadBank bank;
+			FilterBandpass designer;
+			float fcDesigned, qDesigned;
+			int controlRate;
+			bool designed;
+
+			/* fc, q, ramp */
+			void design(float, float, bool) noexcept;
 		};
 		
 		struct DelayFeedback
 		{
+			using Interpolator = interpolate::CubicHermiteSpline;
+
 			DelayFeedback();
 
 			/* delaySize */
 			void prepare(int);
 
-			/* samples, numChannels, numSamples, wHead, rHead, feedback */
-			void operator()(float* const*, int, int, const int*, const float*, const float*) noexcept;
+			/* samples, numChannels, numSamples, delay (samples), feedback */
+			void operator()(float* const*, int, int, const float*, const float*) noexcept;
 
-			AudioBuffer ringBuffer;
-			int size;
+			RingBuffer<Interpolator> ringBuffer;
 		};
 		
 		struct RingMod
@@ -52,7 +78,7 @@ namespace audio
 
 			RingMod();
 
-			void createWavetable(const WTFunc&) noexcept;
+			void createWavetable(const WTFunc&);
 
 			/* Fs, blockSize */
 			void prepare(float, int);
@@ -63,7 +89,7 @@ namespace audio
 			WT waveTable;
 		protected:
 			Phasor<float> phasor;
-			std::vector<float> oscBuffer;
+			std::vector<float> oscBuffer, phaseBuffer, incBuffer;
 		};
 
 		struct Lane
@@ -73,10 +99,13 @@ namespace audio
 			/* sampleRate, blockSize, delaySize */
 			void prepare(float, int, int);
 
+			/* controlRate [1, N] samples */
+			void setControlRate(int) noexcept;
+
 			/* samples, numChannels, numSamples, enabled, pitch, resonance, slope, drive, feedback,
-			oct, semi, rmOct, rmSemi, rmDepth, gain, wHead, xen */
+			oct, semi, rmOct, rmSemi, rmDepth, gain, xen */
 			void operator()(float* const*, int, int, bool, float, float, int, float, float,
-				float, float, float, float, float, float, const int*, const XenManager&) noexcept;
+				float, float, float, float, float, float, const XenManager&) noexcept;
 
 			/* state, laneIndex */
 			void savePatch(sta::State&, int);
@@ -90,14 +119,10 @@ namespace audio
 			RingMod ringMod;
 		protected:
 			AudioBuffer laneBuffer;
-			std::vector<float> readHead;
 			Filter filter;
 			PRM frequency, resonance, drive, feedback, delayRate, rmDepth, rmFreqHz, gain;
 			DelayFeedback delayFB;
-			float Fs, delaySizeF;
-
-			/* numSamples, wHead, delayBuf */
-			const float* getRHead(int, const int*, const float*) noexcept;
+			float Fs;
 
 			/* x, d */
 			float distort(float, float) const noexcept;
@@ -112,8 +137,16 @@ namespace audio
 	public:
 		Manta(const XenManager&);
 
-		/* sampleRate, blockSize */
-		void prepare(float, int);
+		/*
+		* sampleRate, blockSize, parallel
+		parallel runs the lanes of blocks >= MinParallelBlockSize on worker threads,
+		for example while rendering offline (isNonRealtime()).
+		starts or stops the workers, so only call it while not processing (prepareToPlay)
+		*/
+		void prepare(float, int, bool);
+
+		/* controlRate [1, N] samples, of the lane filters' coefficients */
+		void setControlRate(int) noexcept;
 
 		/* samples, numChannels, numSamples,
 		* l1Enabled [0, 1], l1Snap, l1Pitch [12, N]note, l1Resonance [1, N]q, l1Slope [1, 4]db/oct, l1Drive [0, 1]%, l1Feedback [0, 1]%, l1Oct[-3,3], l1Semi[-12,12], l1RMOct[-3,3], l1RMSemi[-12,12], l1RMDepth[0,1], l1Gain [-60, 60]db
@@ -136,9 +169,23 @@ namespace audio
 		const WT& getWaveTable(int) const noexcept;
 		
 	protected:
+		struct LaneParams
+		{
+			bool enabled;
+			float pitch, resonance;
+			int slope;
+			float drive, feedback, oct, semi, rmOct, rmSemi, rmDepth, gain;
+		};
+
 		const XenManager& xen;
 		std::array<Lane, NumLanes> lanes;
-		WHead writeHead;
+		std::array<LaneParams, NumLanes> laneParams;
+		WorkerPool workerPool;
+		float* const* blockSamples;
+		int blockNumChannels, blockNumSamples;
+
+		/* manta, laneIdx */
+		static void processLane(void*, int) noexcept;
 	public:
 		int delaySize;
 	};
@@ -8,7 +8,6 @@ namespace audio
 	Meters::Val::Val() :
 		rect(0.f),
 		val(0.f),
-		env(0.f),
 		envFol()
 	{};
 
@@ -16,143 +15,189 @@ namespace audio
 
 	Meters::Meters() :
 		vals(),
-		wHead(),
+#if PPDMetersLoudness
+		truePeak(),
+		loudness(),
+		truePeakDisplay(0.f),
+		momentaryDisplay(loudness.getMomentary()),
+		shortTermDisplay(loudness.getShortTerm()),
+		truePeakVal(0.f),
+#endif
+		frame(),
+		frames(),
+		display(),
 		lenInv(1.f),
-		length(1)
+		length(1),
+		windowPos(0),
+		blockPos(0),
+		framePending(false)
 	{
+		frame.env.fill(0.f);
+#if PPDMetersLoudness
+		frame.truePeak = 0.f;
+		frame.momentary = frame.shortTerm = loudness.getMomentary();
+#endif
+		for (auto& d : display)
+			d.store(0.f);
 	}
 
 	void Meters::prepare(float sampleRate, int blockSize)
 	{
 		length = static_cast<int>(sampleRate / PPDFPSMeters);
-		wHead.prepare(blockSize, length);
+		windowPos = blockPos = 0;
+		framePending = false;
 		lenInv = 1.f / static_cast<float>(length);
 		for (auto& v : vals)
+		{
+			v.rect = 0.f;
 			v.envFol.prepare(PPDFPSMeters);
+		}
+#if PPDMetersLoudness
+		truePeak.clear();
+		truePeakVal = 0.f;
+		loudness.prepare(sampleRate, blockSize);
+#endif
 	}
 
 #if PPDHasGainIn
 	void Meters::processIn(const float* const* samples, int numChannels, int numSamples) noexcept
 	{
-		wHead(numSamples);
-
-		process(vals[Type::In], samples, numChannels, numSamples);
+		// a frame that processOut didn't complete last block, because it isn't called
+		if (framePending)
+		{
+			frames.push(frame);
+			framePending = false;
+		}
+		beginBlock(numSamples);
+		process(Type::In, samples, numChannels, numSamples);
 	}
 #endif
 
 	void Meters::processOut(const float* const* samples, int numChannels, int numSamples) noexcept
 	{
 #if !PPDHasGainIn
-		wHead(numSamples);
+		beginBlock(numSamples);
+#endif
+#if PPDMetersLoudness
+		loudness(samples, numChannels, numSamples);
+#endif
+		process(Type::Out, samples, numChannels, numSamples);
+	}
+
+	void Meters::update() noexcept
+	{
+		const auto f = frames.back();
+		if (f == nullptr)
+			return;
+		for (auto i = 0; i < NumTypes; ++i)
+			display[i].store(f->env[i]);
+#if PPDMetersLoudness
+		truePeakDisplay.store(f->truePeak);
+		momentaryDisplay.store(f->momentary);
+		shortTermDisplay.store(f->shortTerm);
 #endif
-		process(vals[Type::Out], samples, numChannels, numSamples);
+		frames.pop();
 	}
 
 	const std::atomic<float>& Meters::operator()(int i) const noexcept
 	{
-		return vals[i].env;
+		return display[i];
 	}
 
-	void Meters::process(Val& val, const float* const* samples, int numChannels, int numSamples) noexcept
+#if PPDMetersLoudness
+	float Meters::getTruePeak() const noexcept
 	{
-		auto& rect = val.rect;
-		auto& vVal = val.val;
-		auto& envFol = val.envFol;
+		return truePeakDisplay.load();
+	}
 
-#if PPDMetersUseRMS
-		if (numChannels == 1)
-		{
-			auto smpls = samples[0];
+	float Meters::getMomentary() const noexcept
+	{
+		return momentaryDisplay.load();
+	}
 
+	float Meters::getShortTerm() const noexcept
+	{
+		return shortTermDisplay.load();
+	}
+#endif
 
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				const auto w = wHead[s];
-
-				if (w == 0)
-				{
-					vVal = std::sqrt(rect * lenInv);
-					val.env.store(envFol.process(
-						vVal,
-						RiseInMs,
-						FallInMs
-					));
-
-					rect = 0.f;
-				}
-
-				const auto smpl = smpls[s];
-				rect += smpl * smpl;
-			}
+	void Meters::publish(int type, float env) noexcept
+	{
+		frame.env[type] = env;
+		// processOut comes last, so the frame is complete here
+		if (type == Type::Out)
+		{
+#if PPDMetersLoudness
+			frame.truePeak = truePeakVal;
+			frame.momentary = loudness.getMomentary();
+			frame.shortTerm = loudness.getShortTerm();
+			truePeakVal = 0.f;
+#endif
+			frames.push(frame);
+			framePending = false;
 		}
 		else
+			framePending = true;
+	}
+
+	void Meters::beginBlock(int numSamples) noexcept
+	{
+		blockPos = windowPos;
+		windowPos = (windowPos + numSamples) % length;
+	}
+
+	void Meters::process(int type, const float* const* samples, int numChannels, int numSamples) noexcept
+	{
+		auto& val = vals[type];
+
+		// the window boundary splits the block, so the reductions run over whole chunks
+		auto pos = blockPos;
+		auto s = 0;
+		while (s < numSamples)
 		{
-			for (auto s = 0; s < numSamples; ++s)
+			const auto remaining = length - pos;
+			const auto n = numSamples - s < remaining ? numSamples - s : remaining;
+			accumulate(type, samples, numChannels, s, n);
+			s += n;
+			pos += n;
+
+			if (pos == length)
 			{
-				const auto w = wHead[s];
-
-				if (w == 0)
-				{
-					vVal = std::sqrt(rect * lenInv) * .5f;
-					val.env.store(envFol.process(
-						vVal,
-						RiseInMs,
-						FallInMs
-					));
-
-					rect = 0.f;
-				}
-
-				const auto smpl = samples[0][s] + samples[1][s];
-				rect += smpl * smpl;
+#if PPDMetersUseRMS
+				val.val = std::sqrt(val.rect * lenInv / static_cast<float>(numChannels));
+#else
+				val.val = val.rect;
+#endif
+				val.rect = 0.f;
+				pos = 0;
+				publish(type, val.envFol.process(
+					val.val,
+					RiseInMs,
+					FallInMs
+				));
 			}
 		}
-#else
-		if (numChannels == 1)
-		{
-			const auto smpls = samples[0];
+	}
 
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				const auto w = wHead[s];
-
-				if (w == 0)
-				{
-					vVal = std::sqrt(rect);
-					val.env.store(envFol.process(
-						vVal,
-						RiseInMs,
-						FallInMs
-					));
-
-					rect = 0.f;
-				}
-
-				const auto smpl = smpls[s];
-				rect = rect < smpl ? smpl : rect;
-			}
+	void Meters::accumulate(int type, const float* const* samples, int numChannels, int startIdx, int numSamples) noexcept
+	{
+		auto& rect = vals[type].rect;
+
+		for (auto ch = 0; ch < numChannels; ++ch)
+		{
+#if PPDMetersUseRMS
+			rect += sumOfSquares(samples[ch] + startIdx, numSamples);
+#else
+			const auto peak = absMax(samples[ch] + startIdx, numSamples);
+			rect = rect < peak ? peak : rect;
+#endif
 		}
-		else
+
+#if PPDMetersLoudness
+		if (type == Type::Out)
 		{
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				const auto w = wHead[s];
-
-				if (w == 0)
-				{
-					vVal = rect * .5f;
-					val.env.store(envFol.process(
-						vVal,
-						RiseInMs,
-						FallInMs
-					));
-
-					rect = 0.f;
-				}
-
-				const auto smpl = samples[0][s] + samples[1][s];
-				rect = rect < smpl ? smpl : rect;
-			}
+			const auto peak = truePeak(samples, numChannels, startIdx, numSamples);
+			truePeakVal = truePeakVal < peak ? peak : truePeakVal;
 		}
 #endif
 	}
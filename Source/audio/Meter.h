@@ -1,6 +1,7 @@
 #pragma once
-#include "WHead.h"
+#include "Loudness.h"
 #include "EnvelopeFollower.h"
+#include "FrameQueue.h"
 #include <array>
 #include <atomic>
 
@@ -15,7 +16,6 @@ namespace audio
 			Val();
 
 			float rect, val;
-			std::atomic<float> env;
 			EnvFol envFol;
 		};
 	
@@ -28,6 +28,17 @@ namespace audio
 			Out,
 			NumTypes
 		};
+
+		// published per meter window
+		struct Frame
+		{
+			std::array<float, NumTypes> env;
+#if PPDMetersLoudness
+			// of the output
+			float truePeak, momentary, shortTerm;
+#endif
+		};
+		static constexpr int NumFrames = 64;
 	
 		Meters();
 
@@ -41,16 +52,51 @@ namespace audio
 		/*samples,numChannels,numSamples*/
 		void processOut(const float* const*, int, int) noexcept;
 
+		/* pulls the newest frame into the displayed values (message thread) */
+		void update() noexcept;
+
+		/* displayed value (message thread) */
 		const std::atomic<float>& operator()(int i) const noexcept;
 
+#if PPDMetersLoudness
+		/* output's true peak of the last window as gain (message thread) */
+		float getTruePeak() const noexcept;
+
+		/* output's momentary loudness in LUFS (message thread) */
+		float getMomentary() const noexcept;
+
+		/* output's short-term loudness in LUFS (message thread) */
+		float getShortTerm() const noexcept;
+#endif
+
 	protected:
 		std::array<Val, NumTypes> vals;
-		WHead wHead;
+#if PPDMetersLoudness
+		// only metered when the gui has a readout for it, as it costs more than the envelopes
+		TruePeak truePeak;
+		Loudness loudness;
+		std::atomic<float> truePeakDisplay, momentaryDisplay, shortTermDisplay;
+		float truePeakVal;
+#endif
+		Frame frame;
+		FrameQueue<Frame, NumFrames> frames;
+		std::array<std::atomic<float>, NumTypes> display;
 		float lenInv;
-		int length;
+		// the window position of the block that is being metered
+		int length, windowPos, blockPos;
+		bool framePending;
 
 	private:
-		/*val,samples,numChannels,numSamples*/
-		void process(Val&, const float* const*, int, int) noexcept;
+		/*type,samples,numChannels,numSamples*/
+		void process(int, const float* const*, int, int) noexcept;
+
+		/*type,samples,numChannels,startIdx,numSamples*/
+		void accumulate(int, const float* const*, int, int, int) noexcept;
+
+		/*type, envelope value. completes the frame at the output*/
+		void publish(int, float) noexcept;
+
+		/*samples of the block. the first meter of each block moves the window*/
+		void beginBlock(int) noexcept;
 	};
 }
\ No newline at end of file
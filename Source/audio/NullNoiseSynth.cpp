@@ -1,5 +1,125 @@
 #include "NullNoiseSynth.h"
+#include "AudioUtils.h"
+#include <bit>
+#include <cmath>
+#include <mutex>
 
 namespace audio
 {
-}
\ No newline at end of file
+	using File = juce::File;
+	using SpecLoc = File::SpecialLocationType;
+
+	// NullNoiseTable
+
+	std::shared_ptr<const NullNoiseTable> NullNoiseTable::get()
+	{
+		// only weakly held, so the table is freed with the last instance
+		static std::mutex mutex;
+		static std::weak_ptr<NullNoiseTable> shared;
+
+		const std::lock_guard<std::mutex> lock(mutex);
+		auto table = shared.lock();
+		if (table == nullptr)
+		{
+			table = std::make_shared<NullNoiseTable>(CreationKey());
+			shared = table;
+			table->startThread(juce::Thread::Priority::low);
+		}
+		return table;
+	}
+
+	NullNoiseTable::NullNoiseTable(CreationKey) :
+		juce::Thread("NullNoiseTable"),
+		noise(),
+		ready(false)
+	{}
+
+	NullNoiseTable::~NullNoiseTable()
+	{
+		stopThread(4000);
+	}
+
+	bool NullNoiseTable::isReady() const noexcept
+	{
+		return ready.load(std::memory_order_acquire);
+	}
+
+	const float* NullNoiseTable::data() const noexcept
+	{
+		return noise.data();
+	}
+
+	int NullNoiseTable::size() const noexcept
+	{
+		return static_cast<int>(noise.size());
+	}
+
+	void NullNoiseTable::run()
+	{
+		const auto file = File::getSpecialLocation(SpecLoc::currentApplicationFile);
+		juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+		const auto bytes = static_cast<const char*>(mapped.getData());
+		const auto numFloats = bytes == nullptr ? 0 : static_cast<size_t>(mapped.getSize() / sizeof(float));
+
+		// at most one entry per float, so the vector never reallocates
+		noise.reserve(numFloats);
+		for (size_t i = 0; i < numFloats; ++i)
+		{
+			if ((i & 0xffff) == 0 && threadShouldExit())
+				return;
+
+			// same byte order as FileInputStream::readFloat
+			const auto bits = juce::ByteOrder::littleEndianInt(bytes + i * sizeof(float));
+			auto smpl = std::bit_cast<float>(bits);
+			if (!std::isnan(smpl) && !std::isinf(smpl) && smpl != 0.f)
+			{
+				while (smpl < -1.f || smpl > 1.f)
+					smpl *= .5f;
+				noise.push_back(smpl);
+			}
+		}
+		noise.shrink_to_fit();
+
+		ready.store(true, std::memory_order_release);
+	}
+
+	// NullSynth
+
+	NullSynth::NullSynth() :
+		table(NullNoiseTable::get()),
+		readIdx(0)
+	{}
+
+	void NullSynth::prepare(int)
+	{
+		readIdx = 0;
+	}
+
+	void NullSynth::operator()(float** samples, int numChannels, int numSamples) noexcept
+	{
+		const auto size = table->isReady() ? table->size() : 0;
+		if (size == 0)
+		{
+			for (auto ch = 0; ch < numChannels; ++ch)
+				SIMD::clear(samples[ch], numSamples);
+			return;
+		}
+
+		// copied in runs up to the end of the table
+		auto smpls = samples[0];
+		const auto noise = table->data();
+		auto s = 0;
+		while (s < numSamples)
+		{
+			readIdx = readIdx >= size ? 0 : readIdx;
+			const auto remaining = size - readIdx;
+			const auto n = numSamples - s < remaining ? numSamples - s : remaining;
+			SIMD::copy(smpls + s, noise + readIdx, n);
+			s += n;
+			readIdx += n;
+		}
+
+		for (auto ch = 1; ch < numChannels; ++ch)
+			SIMD::copy(samples[ch], smpls, numSamples);
+	}
+}
@@ -3,62 +3,59 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_events/juce_events.h>
 
-#include <cmath>
-#include "WHead.h"
-
-
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace audio
 {
-	struct NullSynth
+	/*
+	* the plugin binary read as floats, without the ones that aren't usable
+	as samples. it is shared by all instances and built once on a background
+	thread from a memory mapping of the binary, so no instance has to wait
+	for it or keep a copy of its own.
+	*/
+	class NullNoiseTable :
+		public juce::Thread
 	{
-		using File = juce::File;
-		using UniqueStream = std::unique_ptr<juce::FileInputStream>;
-		using SpecLoc = File::SpecialLocationType;
-		
-		NullSynth() :
-			noise()
-		{
-			noise.reserve(1 << 17);
-			UniqueStream inputStream(File::getSpecialLocation(SpecLoc::currentApplicationFile).createInputStream());
-			auto& stream = *inputStream;
-
-			while (!stream.isExhausted())
-			{
-				auto smpl = stream.readFloat();
-				if (!std::isnan(smpl) && !std::isinf(smpl) && smpl != 0.f)
-				{
-					while (smpl < -1.f || smpl > 1.f)
-						smpl *= .5f;
-					noise.push_back(smpl);
-				}
-			}
-		}
-
-		void prepare(int blockSize)
-		{
-			wHead.prepare(blockSize, static_cast<int>(noise.size()));
-		}
-
-		void operator()(float** samples, int numChannels, int numSamples) noexcept
-		{
-			wHead(numSamples);
-
-			for (auto ch = 0; ch < numChannels; ++ch)
-			{
-				auto smpls = samples[ch];
-
-				for (auto s = 0; s < numSamples; ++s)
-				{
-					const auto w = wHead[s];
-
-					smpls[s] = noise[w];
-				}
-			}
-		}
-		
-		WHead wHead;
+		struct CreationKey {};
+	public:
+		/* the table of all instances. the first call starts building it */
+		static std::shared_ptr<const NullNoiseTable> get();
+
+		NullNoiseTable(CreationKey);
+
+		~NullNoiseTable() override;
+
+		/* false while the table is being built */
+		bool isReady() const noexcept;
+
+		/* only valid when ready */
+		const float* data() const noexcept;
+
+		/* only valid when ready */
+		int size() const noexcept;
+
+		void run() override;
+
+	protected:
 		std::vector<float> noise;
+		std::atomic<bool> ready;
+	};
+
+	struct NullSynth
+	{
+		NullSynth();
+
+		/* blockSize */
+		void prepare(int);
+
+		/* samples, numChannels, numSamples. silent until the table is ready */
+		void operator()(float**, int, int) noexcept;
+
+	protected:
+		std::shared_ptr<const NullNoiseTable> table;
+		int readIdx;
 	};
 }
 
@@ -69,4 +66,4 @@ it's a fun side project. contributions are welcome
 
 todo: save and load buffer indexes after first opened plugin
 
-*/
\ No newline at end of file
+*/
@@ -1,10 +1,23 @@
 #include "Oscillator.h"
 #include "../arch/Conversion.h"
+#include "../arch/Interpolation.h"
 
 namespace audio
 {
 	// OscSine
 
+	static constexpr int CosTableSize = 1 << 12;
+
+	// one period of cos, +1 guard sample for the block lerp
+	static const std::array<float, CosTableSize + 1> cosTable = []()
+	{
+		std::array<float, CosTableSize + 1> t;
+		for (auto i = 0; i < CosTableSize; ++i)
+			t[i] = std::cos(static_cast<float>(i) * Tau / static_cast<float>(CosTableSize));
+		t[CosTableSize] = t[0];
+		return t;
+	}();
+
 	template<typename Float>
 	OscSine<Float>::OscSine() :
 		phasor()
@@ -31,8 +44,14 @@ namespace audio
 	template<typename Float>
 	Float* OscSine<Float>::operator()(Float* buffer, int numSamples) noexcept
 	{
-		for (auto s = 0; s < numSamples; ++s)
-			buffer[s] = synthesizeSample();
+		if constexpr (std::is_same_v<Float, float>)
+		{
+			phasor(buffer, numSamples);
+			interpolate::lerp(buffer, cosTable.data(), buffer, static_cast<float>(CosTableSize), numSamples);
+		}
+		else
+			for (auto s = 0; s < numSamples; ++s)
+				buffer[s] = synthesizeSample();
 		return buffer;
 	}
 
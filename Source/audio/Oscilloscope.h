@@ -2,16 +2,34 @@
 #include "AudioUtils.h"
 #include "WHead.h"
 #include "Phasor.h"
+#include "FrameQueue.h"
 
 namespace audio
 {
+	/*
+	* streams the signal to the gui in chunks of consecutive window positions.
+	the window itself lives on the gui side, where the chunks are written into it.
+	*/
 	struct Oscilloscope
 	{
+		static constexpr int ChunkSize = 256;
+		static constexpr int NumChunks = 64;
+
+		struct Chunk
+		{
+			std::array<float, ChunkSize> samples;
+			int startIdx, numSamples;
+		};
+
+		using Chunks = FrameQueue<Chunk, NumChunks>;
+
 		Oscilloscope() :
 			wHead(),
-			buffer(),
+			chunks(),
+			chunk(nullptr),
 			phasor(0.),
 			beatLength(1.f),
+			windowSize(1),
 			Fs(0.)
 		{}
 
@@ -19,59 +37,62 @@ namespace audio
 		{
 			Fs = sampleRate;
 
-			auto windowSize = static_cast<int>(Fs) * 4;
-			wHead.prepare(blockSize, windowSize);
-			buffer.resize(windowSize);
+			const auto size = static_cast<int>(Fs) * 4;
+			wHead.prepare(blockSize, size);
+			windowSize.store(size);
 
 			phasor.prepare(1. / Fs);
 		}
 
 		void operator()(const float** samples, int numChannels, int numSamples,
 			const PlayHeadPos& playHead) noexcept
-		{	
-			wHead(numSamples);
-			
-			const auto rateSyncV = 1.;
-
-			const auto bpm = playHead.bpm;
-			const auto bps = bpm * .0166666667;
-			const auto quarterNoteLengthInSamples = Fs / bps;
-			const auto barLengthInSamples = quarterNoteLengthInSamples * 4.;
-			const auto beatLen = barLengthInSamples * rateSyncV;
-			phasor.inc = 1. / beatLen;
-			beatLength.store(static_cast<float>(beatLen));
-			
-			const auto ppq = playHead.ppqPosition * .25;
-			const auto ppqCh = ppq / rateSyncV;
-
-			phasor.phase.phase = ppqCh - std::floor(ppqCh);
+		{
+			updatePhasor(numSamples, playHead);
 
 			for (auto s = 0; s < numSamples; ++s)
 			{
-				auto w = wHead[s];
-				
-				const auto phaseInfo = phasor();
-				if (phaseInfo.retrig)
-				{
-					wHead.shift(-w, numSamples);
-					w = wHead[s];
-				}
-
-				buffer[w] = samples[0][s];
-			}
-			
-			if (numChannels == 2)
-			{
-				for (auto s = 0; s < numSamples; ++s)
-				{
-					const auto w = wHead[s];
-					buffer[w] = (buffer[w] + samples[1][s]) * .5f;
-				}
+				auto smpl = samples[0][s];
+				if (numChannels == 2)
+					smpl = (smpl + samples[1][s]) * .5f;
+				write(s, smpl, numSamples);
 			}
 		}
 
 		void operator()(const float* samples, int numSamples,
 			const PlayHeadPos& playHead) noexcept
+		{
+			updatePhasor(numSamples, playHead);
+
+			for (auto s = 0; s < numSamples; ++s)
+				write(s, samples[s], numSamples);
+		}
+
+		/* gui thread, release with chunks.pop() */
+		Chunks& getChunks() noexcept
+		{
+			return chunks;
+		}
+
+		const int windowLength() const noexcept
+		{
+			return windowSize.load();
+		}
+
+		const float getBeatLength() const noexcept
+		{
+			return beatLength.load();
+		}
+	protected:
+		WHead wHead;
+		Chunks chunks;
+		Chunk* chunk;
+		Phasor<double> phasor;
+		std::atomic<float> beatLength;
+		std::atomic<int> windowSize;
+		double Fs;
+
+		/* numSamples, playHead */
+		void updatePhasor(int numSamples, const PlayHeadPos& playHead) noexcept
 		{
 			wHead(numSamples);
 
@@ -89,41 +110,37 @@ namespace audio
 			const auto ppqCh = ppq / rateSyncV;
 
 			phasor.phase.phase = ppqCh - std::floor(ppqCh);
+		}
 
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				auto w = wHead[s];
-
-				const auto phaseInfo = phasor();
-				if (phaseInfo.retrig)
-				{
-					wHead.shift(-w, numSamples);
-					w = wHead[s];
-				}
+		/* s, smpl, numSamples */
+		void write(int s, float smpl, int numSamples) noexcept
+		{
+			auto w = wHead[s];
 
-				buffer[w] = samples[s];
+			const auto phaseInfo = phasor();
+			if (phaseInfo.retrig)
+			{
+				wHead.shift(-w, numSamples);
+				w = wHead[s];
 			}
-		}
 
-		const float* data() const noexcept
-		{
-			return buffer.data();
-		}
-		
-		const size_t windowLength() const noexcept
-		{
-			return buffer.size();
-		}
+			// a chunk only holds consecutive positions
+			if (chunk != nullptr && (chunk->numSamples == ChunkSize || chunk->startIdx + chunk->numSamples != w))
+			{
+				chunks.endWrite();
+				chunk = nullptr;
+			}
+			if (chunk == nullptr)
+			{
+				chunk = chunks.beginWrite();
+				if (chunk == nullptr)
+					return;
+				chunk->startIdx = w;
+				chunk->numSamples = 0;
+			}
 
-		const float getBeatLength() const noexcept
-		{
-			return beatLength.load();
+			chunk->samples[chunk->numSamples] = smpl;
+			++chunk->numSamples;
 		}
-	protected:
-		WHead wHead;
-		std::vector<float> buffer;
-		Phasor<double> phasor;
-		std::atomic<float> beatLength;
-		double Fs;
 	};
 }
\ No newline at end of file
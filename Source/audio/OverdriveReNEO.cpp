@@ -9,6 +9,7 @@
 */
 
 #include "OverdriveReNEO.h"
+#include "../arch/Vec4.h"
 
 namespace audio
 {
@@ -74,9 +75,17 @@ namespace audio
 	void OverdriveReNeo::operator()(float* const* samples, int numChannels, int numSamples,
 		float driveP, float muffleP, float panP, float scrapP) noexcept
 	{
+		const auto driveVal = 2.f + GlueBoost * driveP;
 		const auto muffleBuf = muffled(muffleP, numSamples);
-		const auto driveBuf = drive(2.f + GlueBoost * driveP, numSamples);
+		const auto driveBuf = drive(driveVal, numSamples);
 		const auto scrapBuf = scrap(scrapP, numSamples);
+		// the kernels read the buffers, which only get written while smoothing
+		if (!muffled.smoothing)
+			SIMD::fill(muffleBuf, muffleP, numSamples);
+		if (!drive.smoothing)
+			SIMD::fill(driveBuf, driveVal, numSamples);
+		if (!scrap.smoothing)
+			SIMD::fill(scrapBuf, scrapP, numSamples);
 
 		if (numChannels == 1)
 			processBlockMono(samples[0], numSamples, muffleBuf, driveBuf, filtr[0], scrapBuf);
@@ -94,6 +103,7 @@ namespace audio
 	{
 		muffleGain.evaluate
 		(
+			"OverdriveReNeo muffle", AutoGainVersion, {},
 			[&](float sampleRate, int blockSize)
 			{
 				prepare(sampleRate, blockSize);
@@ -110,6 +120,7 @@ namespace audio
 
 		driveGain.evaluate
 		(
+			"OverdriveReNeo drive", AutoGainVersion, { &muffleGain },
 			[&](float sampleRate, int blockSize)
 			{
 				prepare(sampleRate, blockSize);
@@ -126,6 +137,7 @@ namespace audio
 
 		scrapGain.evaluate
 		(
+			"OverdriveReNeo scrap", AutoGainVersion, { &muffleGain, &driveGain },
 			[&](float sampleRate, int blockSize)
 			{
 				prepare(sampleRate, blockSize);
@@ -144,17 +156,9 @@ namespace audio
 	void OverdriveReNeo::processBlockMono(float* smpls, int numSamples,
 		const float* muffleBuf, const float* driveBuf, Filter& fltr, const float* scrapBuf) noexcept
 	{
-		for (auto s = 0; s < numSamples; ++s)
-		{
-			fltr.setFreq(muffleBuf[s], Fs);
-
-			auto smpl = smpls[s];
-
-			smpl = waveshape(smpl, driveBuf[s], scrapBuf[s]);
-			smpl = fltr(smpl);
-
-			smpls[s] = applyAutoGain(smpl, muffleBuf[s], driveBuf[s], scrapBuf[s]);
-		}
+		waveshape(smpls, driveBuf, scrapBuf, numSamples);
+		filter(smpls, numSamples, muffleBuf, fltr);
+		applyAutoGain(smpls, numSamples, muffleBuf, driveBuf, scrapBuf);
 	}
 
 	void OverdriveReNeo::processBlockStereo(float* const* samples, int numChannels, int numSamples,
@@ -180,25 +184,78 @@ namespace audio
 		}
 	}
 
-	float OverdriveReNeo::waveshape(float x, float p, float xy) const noexcept
+	void OverdriveReNeo::waveshape(float* smpls, const float* driveBuf, const float* scrapBuf, int numSamples) const noexcept
 	{
-		x *= DriveBoost;
+		using Vec4 = simd::Vec4;
+
+		// sign(x) * |x|^d, with the power taken as 2^(d * log2|x|)
+		const auto kernel = [](const Vec4& smpl, const Vec4& p, const Vec4& xy)
+		{
+			const auto x = smpl * Vec4(DriveBoost);
+			const auto xx = x * x * x * x;
+			const auto d = Vec4(1.f) / (p + xy * (xx * p - p));
+			const auto mag = Vec4::max(Vec4::abs(x), Vec4(1e-30f));
+			return Vec4::copySign(Vec4::exp2(d * Vec4::log2(mag)), x);
+		};
+
+		auto s = 0;
+		for (; s + Vec4::NumLanes <= numSamples; s += Vec4::NumLanes)
+		{
+			const auto y = kernel(Vec4::load(smpls + s), Vec4::load(driveBuf + s), Vec4::load(scrapBuf + s));
+			y.store(smpls + s);
+		}
 
-		const auto xx = x * x * x * x;
-		const auto d = 1.f / (p + xy * (xx * p - p));
+		const auto numRemaining = numSamples - s;
+		if (numRemaining == 0)
+			return;
+		// the tail runs through the same kernel with padded lanes
+		float x[Vec4::NumLanes] = { 0.f, 0.f, 0.f, 0.f };
+		float p[Vec4::NumLanes] = { 2.f, 2.f, 2.f, 2.f };
+		float xy[Vec4::NumLanes] = { 0.f, 0.f, 0.f, 0.f };
+		for (auto i = 0; i < numRemaining; ++i)
+		{
+			x[i] = smpls[s + i];
+			p[i] = driveBuf[s + i];
+			xy[i] = scrapBuf[s + i];
+		}
+		kernel(Vec4::load(x), Vec4::load(p), Vec4::load(xy)).store(x);
+		for (auto i = 0; i < numRemaining; ++i)
+			smpls[s + i] = x[i];
+	}
 
-		if (x > 0.f)
-			return std::pow(x, d);
-		return -std::pow(-x, d);
+	void OverdriveReNeo::filter(float* smpls, int numSamples, const float* muffleBuf, Filter& fltr) const noexcept
+	{
+		// coefficients are updated at control rate, because designing them calls exp
+		const auto interval = muffled.smoothing ? ControlRate : numSamples;
+		for (auto s = 0; s < numSamples; s += interval)
+		{
+			fltr.setFreq(muffleBuf[s], Fs);
+			const auto end = s + interval < numSamples ? s + interval : numSamples;
+			for (auto i = s; i < end; ++i)
+				smpls[i] = fltr(smpls[i]);
+		}
 	}
 
-	float OverdriveReNeo::applyAutoGain(float x, float ms, float ds, float scp) noexcept
+	void OverdriveReNeo::applyAutoGain(float* smpls, int numSamples,
+		const float* muffleBuf, const float* driveBuf, const float* scrapBuf) const noexcept
 	{
-		x = muffleGain.fromDenorm(x, ms);
-		x = driveGain(x, (ds - 2.f) * GlueBoostInv);
-		x = scrapGain(x, scp);
+		const auto last = numSamples - 1;
+		const auto gStart = getAutoGain(muffleBuf[0], driveBuf[0], scrapBuf[0]);
+		const auto gEnd = getAutoGain(muffleBuf[last], driveBuf[last], scrapBuf[last]);
 
-		return x;
+		if (gStart == gEnd || last == 0)
+			return SIMD::multiply(smpls, gStart, numSamples);
+
+		const auto inc = (gEnd - gStart) / static_cast<float>(last);
+		for (auto s = 0; s < numSamples; ++s)
+			smpls[s] *= gStart + inc * static_cast<float>(s);
+	}
+
+	float OverdriveReNeo::getAutoGain(float ms, float ds, float scp) const noexcept
+	{
+		return muffleGain.getGainFromDenorm(ms)
+			* driveGain.getGain((ds - 2.f) * GlueBoostInv)
+			* scrapGain.getGain(scp);
 	}
 
 	void OverdriveReNeo::updatePanVecs(float panP, int numSamples) noexcept
@@ -34,9 +34,13 @@ namespace audio
 		};
 
 		static constexpr float DriveBoost = 420.f;
+		// samples between filter coefficient updates while muffle is smoothing
+		static constexpr int ControlRate = 16;
 
 		static constexpr float GlueBoost = 8.f;
 		static constexpr float GlueBoostInv = 1.f / GlueBoost;
+		// raise whenever the waveshaper or filter change, so cached autogain tables are re-evaluated
+		static constexpr int AutoGainVersion = 1;
 		
 		/* pinkNoise, muffleRange */
 		OverdriveReNeo(PinkNoise&, const Range&);
@@ -66,11 +70,17 @@ namespace audio
 		/* samples, numChannels, numSamples, muffleBuf, driveBuf, pan, scrapBuf */
 		void processBlockStereo(float* const*, int, int, const float*, const float*, float, const float*) noexcept;
 
-		/* x, p, xy */
-		float waveshape(float, float, float) const noexcept;
+		/* smpls, driveBuf, scrapBuf, numSamples */
+		void waveshape(float*, const float*, const float*, int) const noexcept;
 
-		/* x, ms, ds, scp */
-		float applyAutoGain(float, float, float, float) noexcept;
+		/* smpls, numSamples, muffleBuf, fltr */
+		void filter(float*, int, const float*, Filter&) const noexcept;
+
+		/* smpls, numSamples, muffleBuf, driveBuf, scrapBuf. ramps between the gains of the block's ends */
+		void applyAutoGain(float*, int, const float*, const float*, const float*) const noexcept;
+
+		/* ms, ds, scp */
+		float getAutoGain(float, float, float) const noexcept;
 
 		/* pan, numSamples */
 		void updatePanVecs(float, int) noexcept;
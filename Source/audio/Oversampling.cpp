@@ -1,4 +1,5 @@
 #include "Oversampling.h"
+#include <algorithm>
 #include <cmath>
 
 namespace audio
@@ -45,93 +46,170 @@ namespace audio
 
 	/////////////////////////////////////////////////////
 
-	/*
-	* Fs,fc,bw,upsampling
-	Nyquist == Fs / 2
-	fc < Nyquist
-	bw < Nyquist
-	fc + bw < Nyquist
-	*/
-	static std::vector<float> makeWindowedSinc(float Fs, float fc, float bw, bool upsampling)
+	// PartitionedConvolver
+
+	PartitionedConvolver::PartitionedConvolver() :
+		fft(PartitionOrder + 1),
+		headKernel(),
+		tailSpectra(),
+		fdl(),
+		fftBuf(),
+		accBuf(),
+		headRing(),
+		inputBlock(),
+		tailOut(),
+		numChannels(0),
+		numPartitions(0),
+		fdlIdx(0),
+		pos(0)
+	{}
+
+	void PartitionedConvolver::prepare(const ImpulseResponse& ir, int _numChannels)
 	{
-		const auto nyquist = Fs * .5f;
-		if (fc > nyquist || bw > nyquist || fc + bw > nyquist)
-			return {};
+		numChannels = _numChannels;
+		const auto irSize = static_cast<int>(ir.size());
+		const auto tailSize = std::max(irSize - PartitionSize, 0);
+		numPartitions = std::max((tailSize + PartitionSize - 1) / PartitionSize, 1);
 
-		fc /= Fs;
-		bw /= Fs;
+		// reversed, so that the head is a forward dot product over the ring
+		headKernel.assign(PartitionSize, 0.f);
+		for (auto i = 0; i < std::min(irSize, PartitionSize); ++i)
+			headKernel[PartitionSize - 1 - i] = ir[i];
 
-		int M = static_cast<int>(4.f / bw);
-		if (M % 2 != 0)
-			M += 1; // M is even number
+		fftBuf.assign(FFTSize * 2, 0.f);
+		accBuf.assign(SpectrumSize, 0.f);
 
-		const auto Mf = static_cast<float>(M);
-		const auto MHalf = Mf * .5f;
-		const float MInv = 1.f / Mf;
+		tailSpectra.assign(numPartitions * SpectrumSize, 0.f);
+		for (auto p = 0; p < numPartitions; ++p)
+		{
+			std::fill(fftBuf.begin(), fftBuf.end(), 0.f);
+			const auto start = PartitionSize + p * PartitionSize;
+			for (auto i = 0; i < PartitionSize && start + i < irSize; ++i)
+				fftBuf[i] = ir[start + i];
 
-		const int N = M + 1;
+			fft.performRealOnlyForwardTransform(fftBuf.data(), true);
+			std::copy(fftBuf.begin(), fftBuf.begin() + SpectrumSize, tailSpectra.begin() + p * SpectrumSize);
+		}
 
-		const auto h = [&](float i)
-		{ // sinc
-			i -= MHalf;
-			if (i != 0.f)
-				return std::sin(Tau * fc * i) / i;
-			return Tau * fc;
-		};
+		fdl.assign(numChannels * numPartitions * SpectrumSize, 0.f);
+		headRing.setSize(numChannels, PartitionSize * 2, false, true, false);
+		inputBlock.setSize(numChannels, FFTSize, false, true, false);
+		tailOut.setSize(numChannels, PartitionSize, false, true, false);
+		headRing.clear();
+		inputBlock.clear();
+		tailOut.clear();
+		fdlIdx = 0;
+		pos = 0;
+	}
 
-		const auto w = [&, tau2 = Tau * 2.f](float i)
-		{ // blackman window
-			i *= MInv;
-			return .42f - .5f * std::cos(Tau * i) + .08f * std::cos(tau2 * i);
-		};
+	void PartitionedConvolver::processBlock(float* const* samples, int _numChannels, int numSamples) noexcept
+	{
+		_numChannels = std::min(_numChannels, numChannels);
+		const auto head = headKernel.data();
 
-		std::vector<float> ir;
-		ir.reserve(N);
-		for (auto n = 0; n < N; ++n)
+		auto p = pos;
+		auto f = fdlIdx;
+		for (auto ch = 0; ch < _numChannels; ++ch)
 		{
-			auto nF = static_cast<float>(n);
-			ir.emplace_back(h(nF) * w(nF));
-		}
-
-		const auto targetGain = upsampling ? 2.f : 1.f;
-		auto sum = 0.f; // normalize
-		for (const auto n : ir)
-			sum += n;
-		const auto sumInv = targetGain / sum;
-		for (auto& n : ir)
-			n *= sumInv;
+			auto smpls = samples[ch];
+			auto ring = headRing.getWritePointer(ch);
+			auto in = inputBlock.getWritePointer(ch) + PartitionSize;
+			const auto tail = tailOut.getReadPointer(ch);
 
-		return ir;
+			p = pos;
+			f = fdlIdx;
+			for (auto s = 0; s < numSamples; ++s)
+			{
+				const auto x = smpls[s];
+				in[p] = x;
+				// mirrored ring, so the dot product never wraps
+				ring[p] = x;
+				ring[p + PartitionSize] = x;
+
+				smpls[s] = tail[p] + simd::dot(ring + p + 1, head, PartitionSize);
+
+				++p;
+				if (p == PartitionSize)
+				{
+					processTail(ch, f);
+					f = (f + 1) % numPartitions;
+					p = 0;
+				}
+			}
+		}
+		pos = p;
+		fdlIdx = f;
 	}
 
-	/*
-	* Fs,fc,upsampling
-	Nyquist == Fs / 2
-	fc < Nyquist
-	*/
-	static std::vector<float> makeWindowedSinc(float Fs, float fc, bool upsampling)
+	void PartitionedConvolver::processTail(int ch, int slot) noexcept
 	{
-		return makeWindowedSinc(Fs, fc, Fs * .25f - fc - 1.f, upsampling);
+		auto in = inputBlock.getWritePointer(ch);
+		auto buf = fftBuf.data();
+		auto acc = accBuf.data();
+		auto chFdl = fdl.data() + ch * numPartitions * SpectrumSize;
+
+		// spectrum of the last 2 input blocks into the frequency domain delay line
+		std::copy(in, in + FFTSize, buf);
+		std::fill(buf + FFTSize, buf + FFTSize * 2, 0.f);
+		fft.performRealOnlyForwardTransform(buf, true);
+		std::copy(buf, buf + SpectrumSize, chFdl + slot * SpectrumSize);
+
+		std::fill(acc, acc + SpectrumSize, 0.f);
+		for (auto p = 0; p < numPartitions; ++p)
+		{
+			const auto x = chFdl + ((slot - p + numPartitions) % numPartitions) * SpectrumSize;
+			const auto h = tailSpectra.data() + p * SpectrumSize;
+			for (auto b = 0; b < SpectrumSize; b += 2)
+			{
+				acc[b] += x[b] * h[b] - x[b + 1] * h[b + 1];
+				acc[b + 1] += x[b] * h[b + 1] + x[b + 1] * h[b];
+			}
+		}
+
+		std::copy(acc, acc + SpectrumSize, buf);
+		std::fill(buf + SpectrumSize, buf + FFTSize * 2, 0.f);
+		fft.performRealOnlyInverseTransform(buf);
+
+		// overlap-save: only the 2nd half is valid. it plays back during the next block
+		SIMD::copy(tailOut.getWritePointer(ch), buf + PartitionSize, PartitionSize);
+		SIMD::copy(in, in + PartitionSize, PartitionSize);
 	}
 
 	// Convolver
 
 	Convolver::Convolver(const ImpulseResponse& _ir, const WHead& _wHead) :
 		ring(),
+		kernel(),
 		ir(_ir),
 		wHead(_wHead),
-		irSize(0)
+		partitioned(),
+		irSize(0),
+		useFFT(false)
 	{
 	}
 
 	void Convolver::prepare()
 	{
+		const auto numChannels = 2 + (PPDHasSidechain ? 2 : 0);
 		irSize = static_cast<int>(ir.size());
-		ring.setSize(2 + (PPDHasSidechain ? 2 : 0), irSize, false, true, false);
+		useFFT = irSize > FFTThreshold;
+		if (useFFT)
+			partitioned.prepare(ir, numChannels);
+		else
+		{
+			// reversed, so that it runs forward over the history like the ring does
+			kernel.resize(irSize);
+			for (auto i = 0; i < irSize; ++i)
+				kernel[irSize - 1 - i] = ir[i];
+			ring.setSize(numChannels, irSize * 2, false, true, false);
+		}
 	}
 
 	void Convolver::processBlock(float* const* samples, int numChannels, int numSamples) noexcept
 	{
+		if (useFFT)
+			return partitioned.processBlock(samples, numChannels, numSamples);
+
 		for (auto ch = 0; ch < numChannels; ++ch)
 		{
 			auto smpls = samples[ch];
@@ -149,51 +227,421 @@ namespace audio
 
 	float Convolver::processSample(float smpl, float* rng, int w) noexcept
 	{
+		// mirrored ring, so the last irSize samples are always contiguous
 		rng[w] = smpl;
+		rng[w + irSize] = smpl;
+
+		return simd::dot(rng + w + 1, kernel.data(), irSize);
+	}
+
+	/////////////////////////////////////////////////////
 
-		auto y = 0.f;
-		auto r = w;
+	/*
+	* Fs (upsampled), passbandHz
+	blackman-windowed sinc with cutoff at Fs / 4 and
+	its transition band centered around it.
+	a half-band is always -6dB at Fs / 4, so unlike a plain lowpass
+	the passband edge can't sit below the base rate's nyquist. the kernel
+	is long enough for the blackman window to be flat (-.1dB) at passbandHz
+	and below -75dB from Fs / 2 - passbandHz on. only the images between
+	Fs / 4 and Fs / 2 - passbandHz fold back, into passbandHz..Fs / 4
+	(19 to 22.05kHz at 44.1kHz).
+	length is M + 1 with M == 4K + 2, so the centre tap
+	lands on an odd index and all even offsets from it are 0.
+	*/
+	static std::vector<float> makeHalfBandSinc(float Fs, float passbandHz)
+	{
+		const auto quarterFs = Fs * .25f;
+		passbandHz = std::min(passbandHz, quarterFs * .9f);
+		const auto bw = 2.f * (quarterFs - passbandHz) / Fs;
+
+		// blackman needs about 5.5 / M to get from the passband to its sidelobe floor
+		auto M = static_cast<int>(std::ceil(5.5f / bw));
+		M += (6 - M % 4) % 4;
 
-		for (auto i = 0; i < irSize; ++i)
+		const auto centre = M / 2;
+		const auto MInv = 1.f / static_cast<float>(M);
+
+		const auto w = [&, tau2 = Tau * 2.f](float i)
+		{ // blackman window
+			i *= MInv;
+			return .42f - .5f * std::cos(Tau * i) + .08f * std::cos(tau2 * i);
+		};
+
+		std::vector<float> ir(M + 1, 0.f);
+		auto sum = 0.f;
+		for (auto n = 0; n <= M; ++n)
 		{
-			y += rng[r] * ir[i];
-			--r;
-			if (r == -1)
-				r = irSize - 1;
+			const auto i = n - centre;
+			if (i % 2 != 0)
+			{
+				const auto iF = static_cast<float>(i);
+				ir[n] = std::sin(PiHalf * iF) / (Pi * iF) * w(static_cast<float>(n));
+				sum += ir[n];
+			}
 		}
 
-		return y;
+		// normalize both polyphase branches to a gain of .5
+		const auto sumInv = .5f / sum;
+		for (auto& n : ir)
+			n *= sumInv;
+		ir[centre] = .5f;
+
+		return ir;
 	}
 
-	/////////////////////////////////////////////////////
-	
-	/* samplesUp, samplesIn, numChannels, numSamples1x */
-	static void zeroStuff(float* const* samplesUp, const float* const* samplesIn, int numChannels, int numSamples1x) noexcept
+	// HalfBandFIR
+
+	HalfBandFIR::HalfBandFIR() :
+		kernel(),
+		centreTap(.5f),
+		numTaps(0),
+		centreDelay(0),
+		extraDelay(0)
+	{}
+
+	void HalfBandFIR::makeKernel(float Fs, float passbandHz, bool upsampling)
 	{
+		const auto ir = makeHalfBandSinc(Fs, passbandHz);
+		const auto M = static_cast<int>(ir.size()) - 1;
+		const auto gain = upsampling ? 2.f : 1.f;
+
+		// the even branch is symmetric, so it doesn't need to be reversed
+		numTaps = M / 2 + 1;
+		kernel.resize(numTaps);
+		for (auto i = 0; i < numTaps; ++i)
+			kernel[i] = ir[i * 2] * gain;
+
+		centreTap = ir[M / 2] * gain;
+		centreDelay = (M - 2) / 4;
+		extraDelay = 0;
+	}
+
+	const int HalfBandFIR::getLatency() const noexcept
+	{
+		return (centreDelay + extraDelay) * 2 + 1;
+	}
+
+	const int HalfBandFIR::getNumTaps() const noexcept
+	{
+		return numTaps;
+	}
+
+	// HalfBandUpsampler
+
+	HalfBandUpsampler::HalfBandUpsampler() :
+		HalfBandFIR(),
+		history(),
+		evenBuf(),
+		historySize(0)
+	{}
+
+	void HalfBandUpsampler::prepare(int numChannels, int blockSize1x)
+	{
+		historySize = numTaps - 1;
+		history.setSize(numChannels, historySize + blockSize1x, false, true, false);
+		evenBuf.resize(blockSize1x);
+	}
+
+	void HalfBandUpsampler::clear() noexcept
+	{
+		history.clear();
+	}
+
+	void HalfBandUpsampler::operator()(float* const* samplesUp, const float* const* samplesIn,
+		int numChannels, int numSamples1x) noexcept
+	{
+		auto even = evenBuf.data();
+		const auto k = kernel.data();
+
 		for (auto ch = 0; ch < numChannels; ++ch)
 		{
+			auto hist = history.getWritePointer(ch);
 			auto upBuf = samplesUp[ch];
-			const auto inBuf = samplesIn[ch];
 
+			SIMD::copy(hist + historySize, samplesIn[ch], numSamples1x);
+
+			SIMD::copyWithMultiply(even, hist, k[0], numSamples1x);
+			for (auto i = 1; i < numTaps; ++i)
+				SIMD::addWithMultiply(even, hist + i, k[i], numSamples1x);
+
+			// odd branch is only the centre tap
+			const auto odd = hist + historySize - centreDelay;
 			for (auto s = 0; s < numSamples1x; ++s)
 			{
 				const auto s2 = s * 2;
-				upBuf[s2] = inBuf[s];
-				upBuf[s2 + 1] = 0.f;
+				upBuf[s2] = even[s];
+				upBuf[s2 + 1] = odd[s] * centreTap;
 			}
+
+			std::copy(hist + numSamples1x, hist + numSamples1x + historySize, hist);
 		}
 	}
 
-	/* samplesOut, samplesUp, numChannels, numSamples1x */
-	static void decimate(float* const* samplesOut, const float* const* samplesUp, int numChannels, int numSamples1x) noexcept
+	// HalfBandDownsampler
+
+	HalfBandDownsampler::HalfBandDownsampler() :
+		HalfBandFIR(),
+		historyEven(),
+		historyOdd(),
+		historySizeEven(0),
+		historySizeOdd(0)
+	{}
+
+	void HalfBandDownsampler::prepare(int numChannels, int blockSize1x, int _extraDelay)
 	{
+		// a longer history delays both branches by extraDelay
+		extraDelay = _extraDelay;
+		historySizeEven = numTaps - 1 + extraDelay;
+		historySizeOdd = centreDelay + 1 + extraDelay;
+		historyEven.setSize(numChannels, historySizeEven + blockSize1x, false, true, false);
+		historyOdd.setSize(numChannels, historySizeOdd + blockSize1x, false, true, false);
+	}
+
+	void HalfBandDownsampler::clear() noexcept
+	{
+		historyEven.clear();
+		historyOdd.clear();
+	}
+
+	void HalfBandDownsampler::operator()(float* const* samplesOut, const float* const* samplesUp,
+		int numChannels, int numSamples1x) noexcept
+	{
+		const auto k = kernel.data();
+
 		for (auto ch = 0; ch < numChannels; ++ch)
 		{
+			auto histEven = historyEven.getWritePointer(ch);
+			auto histOdd = historyOdd.getWritePointer(ch);
+			const auto upBuf = samplesUp[ch];
 			auto outBuf = samplesOut[ch];
+
+			{
+				auto e = histEven + historySizeEven;
+				auto o = histOdd + historySizeOdd;
+				for (auto s = 0; s < numSamples1x; ++s)
+				{
+					const auto s2 = s * 2;
+					e[s] = upBuf[s2];
+					o[s] = upBuf[s2 + 1];
+				}
+			}
+
+			SIMD::copyWithMultiply(outBuf, histOdd, centreTap, numSamples1x);
+			for (auto i = 0; i < numTaps; ++i)
+				SIMD::addWithMultiply(outBuf, histEven + i, k[i], numSamples1x);
+
+			std::copy(histEven + numSamples1x, histEven + numSamples1x + historySizeEven, histEven);
+			std::copy(histOdd + numSamples1x, histOdd + numSamples1x + historySizeOdd, histOdd);
+		}
+	}
+
+	/////////////////////////////////////////////////////
+
+	/*
+	* polyphase IIR half-band design by elliptic prototype
+	(after Valenzuela & Constantinides, as used in Laurent de Soras' HIIR).
+	transition band is normalized to Fs, stopband attenuation in dB.
+	*/
+	namespace halfBandIIR
+	{
+		static constexpr double PiD = 3.14159265358979323846;
+
+		/* k, q, transitionBw */
+		static void getTransitionParams(double& k, double& q, double transitionBw)
+		{
+			k = std::tan((1. - transitionBw * 2.) * PiD * .25);
+			k *= k;
+			const auto kksqrt = std::pow(1. - k * k, .25);
+			const auto e = .5 * (1. - kksqrt) / (1. + kksqrt);
+			const auto e4 = e * e * e * e;
+			q = e * (1. + e4 * (2. + e4 * (15. + 150. * e4)));
+		}
+
+		/* attenuationDb, q */
+		static int getFilterOrder(double attenuationDb, double q)
+		{
+			const auto attnP2 = std::pow(10., -attenuationDb / 10.);
+			const auto a = attnP2 / (1. - attnP2);
+			auto order = static_cast<int>(std::ceil(std::log(a * a / 16.) / std::log(q)));
+			if ((order & 1) == 0)
+				++order;
+			if (order == 1)
+				order = 3;
+			return order;
+		}
+
+		/* q, order, c */
+		static double accumulateNumerator(double q, int order, int c)
+		{
+			auto acc = 0.;
+			auto sign = 1.;
+			for (auto i = 0; i < 64; ++i, sign = -sign)
+			{
+				const auto term = std::pow(q, i * (i + 1)) * std::sin((i * 2 + 1) * c * PiD / order) * sign;
+				acc += term;
+				if (std::abs(term) < 1e-100)
+					break;
+			}
+			return acc;
+		}
+
+		/* q, order, c */
+		static double accumulateDenominator(double q, int order, int c)
+		{
+			auto acc = 0.;
+			auto sign = -1.;
+			for (auto i = 1; i < 64; ++i, sign = -sign)
+			{
+				const auto term = std::pow(q, i * i) * std::cos(i * 2 * c * PiD / order) * sign;
+				acc += term;
+				if (std::abs(term) < 1e-100)
+					break;
+			}
+			return acc;
+		}
+
+		/* index, k, q, order */
+		static double getCoefficient(int index, double k, double q, int order)
+		{
+			const auto c = index + 1;
+			const auto num = accumulateNumerator(q, order, c) * std::pow(q, .25);
+			const auto den = accumulateDenominator(q, order, c) + .5;
+			const auto ww = num / den;
+			const auto wwsq = ww * ww;
+			const auto x = std::sqrt((1. - wwsq * k) * (1. - wwsq / k)) / (1. + wwsq);
+			return (1. - x) / (1. + x);
+		}
+	}
+
+	// HalfBandIIR
+
+	HalfBandIIR::HalfBandIIR() :
+		coefs(),
+		states(),
+		numCoefs(0),
+		latency(0.f)
+	{
+		coefs.fill(0.f);
+	}
+
+	void HalfBandIIR::makeCoefficients(float Fs, float passbandHz, float attenuationDb)
+	{
+		using namespace halfBandIIR;
+
+		const auto quarterFs = static_cast<double>(Fs) * .25;
+		const auto passband = std::min(static_cast<double>(passbandHz), quarterFs * .9);
+		const auto transitionBw = (quarterFs - passband) / static_cast<double>(Fs);
+
+		double k, q;
+		getTransitionParams(k, q, transitionBw);
+		const auto order = std::min(getFilterOrder(attenuationDb, q), MaxNumCoefs * 2 + 1);
+		numCoefs = (order - 1) / 2;
+
+		// the even chain sets the group delay of the whole filter at DC
+		latency = 0.f;
+		for (auto i = 0; i < numCoefs; ++i)
+		{
+			const auto coef = getCoefficient(i, k, q, order);
+			coefs[i] = static_cast<float>(coef);
+			if (i % 2 == 0)
+				latency += static_cast<float>(2. * (1. - coef) / (1. + coef));
+		}
+	}
+
+	const float HalfBandIIR::getLatency() const noexcept
+	{
+		return latency;
+	}
+
+	const int HalfBandIIR::getNumCoefs() const noexcept
+	{
+		return numCoefs;
+	}
+
+	void HalfBandIIR::clear() noexcept
+	{
+		for (auto& state : states)
+		{
+			state.x.fill(0.f);
+			state.y.fill(0.f);
+		}
+	}
+
+	void HalfBandIIR::prepareStates(int numChannels)
+	{
+		states.resize(numChannels);
+		clear();
+	}
+
+	float HalfBandIIR::processChain(float smpl, State& state, int firstCoef) noexcept
+	{
+		for (auto i = firstCoef; i < numCoefs; i += 2)
+		{
+			const auto y = (smpl - state.y[i]) * coefs[i] + state.x[i];
+			state.x[i] = smpl;
+			state.y[i] = y;
+			smpl = y;
+		}
+		return smpl;
+	}
+
+	// HalfBandIIRUpsampler
+
+	HalfBandIIRUpsampler::HalfBandIIRUpsampler() :
+		HalfBandIIR()
+	{}
+
+	void HalfBandIIRUpsampler::prepare(int numChannels)
+	{
+		prepareStates(numChannels);
+	}
+
+	void HalfBandIIRUpsampler::operator()(float* const* samplesUp, const float* const* samplesIn,
+		int numChannels, int numSamples1x) noexcept
+	{
+		for (auto ch = 0; ch < numChannels; ++ch)
+		{
+			auto& state = states[ch];
+			const auto smpls = samplesIn[ch];
+			auto upBuf = samplesUp[ch];
+
+			for (auto s = 0; s < numSamples1x; ++s)
+			{
+				const auto s2 = s * 2;
+				upBuf[s2] = processChain(smpls[s], state, 0);
+				upBuf[s2 + 1] = processChain(smpls[s], state, 1);
+			}
+		}
+	}
+
+	// HalfBandIIRDownsampler
+
+	HalfBandIIRDownsampler::HalfBandIIRDownsampler() :
+		HalfBandIIR()
+	{}
+
+	void HalfBandIIRDownsampler::prepare(int numChannels)
+	{
+		prepareStates(numChannels);
+	}
+
+	void HalfBandIIRDownsampler::operator()(float* const* samplesOut, const float* const* samplesUp,
+		int numChannels, int numSamples1x) noexcept
+	{
+		for (auto ch = 0; ch < numChannels; ++ch)
+		{
+			auto& state = states[ch];
 			const auto upBuf = samplesUp[ch];
+			auto smpls = samplesOut[ch];
 
 			for (auto s = 0; s < numSamples1x; ++s)
-				outBuf[s] = upBuf[s * 2];
+			{
+				const auto s2 = s * 2;
+				const auto a = processChain(upBuf[s2 + 1], state, 0);
+				const auto b = processChain(upBuf[s2], state, 1);
+				smpls[s] = .5f * (a + b);
+			}
 		}
 	}
 
@@ -203,92 +651,173 @@ namespace audio
 		Fs(0.),
 		blockSize(0),
 
-		buffer(),
-
-		irUp(),
-		irDown(),
-		wHead(),
+		buffers(),
+		views(),
 
-		filterUp(irUp, wHead),
-		filterDown(irDown, wHead),
+		filtersUp(),
+		filtersDown(),
+		filtersUpIIR(),
+		filtersDownIIR(),
+		stageLatencyFIR(),
+		stageLatencyIIR(),
 
 		FsUp(0.),
 		blockSizeUp(0),
+		latency(0),
 
-		numSamples1x(0), numSamples2x(0),
+		numSamples1x(0),
+		numStages(0),
 
 		enabled(true),
-		enbld(false)
+		order(1),
+		lowLatency(false),
+		enbld(false),
+		lowLtncy(false)
 	{
 	}
 
 	Oversampler::Oversampler(Oversampler& other) :
 		Fs(other.Fs),
 		blockSize(other.blockSize),
-		buffer(other.buffer),
-		irUp(other.irUp),
-		irDown(other.irDown),
-		wHead(other.wHead),
-		filterUp(irUp, wHead),
-		filterDown(irDown, wHead),
+		buffers(other.buffers),
+		views(),
+		filtersUp(other.filtersUp),
+		filtersDown(other.filtersDown),
+		filtersUpIIR(other.filtersUpIIR),
+		filtersDownIIR(other.filtersDownIIR),
+		stageLatencyFIR(other.stageLatencyFIR),
+		stageLatencyIIR(other.stageLatencyIIR),
 		FsUp(other.FsUp),
 		blockSizeUp(other.blockSizeUp),
+		latency(other.latency),
 		numSamples1x(other.numSamples1x),
-		numSamples2x(other.numSamples2x),
+		numStages(other.numStages),
 		enabled(other.enabled.load()),
-		enbld(other.enbld)
+		order(other.order.load()),
+		lowLatency(other.lowLatency.load()),
+		enbld(other.enbld),
+		lowLtncy(other.lowLtncy)
 	{}
 
 	void Oversampler::prepare(const double sampleRate, const int _blockSize)
 	{
-		enbld = isEnabled();
-
 		Fs = sampleRate;
 		blockSize = _blockSize;
 
-		if (enbld)
+		const auto numChannels = 2 + (PPDHasSidechain ? 2 : 0);
+		auto FsStage = Fs;
+		auto blockSizeStage = blockSize;
+
+		for (auto st = 0; st < MaxOrder; ++st)
 		{
-			const auto numChannels = 2 + (PPDHasSidechain ? 2 : 0);
+			FsStage *= 2.;
+			const auto FsStageF = static_cast<float>(FsStage);
+			const auto stageFactor = 1 << st;
+
+			{
+				auto& up = filtersUpIIR[st];
+				auto& down = filtersDownIIR[st];
 
-			FsUp = Fs * 2.;
-			blockSizeUp = blockSize * 2;
+				up.makeCoefficients(FsStageF, PassbandHz, StopbandAttenuationDb);
+				down.makeCoefficients(FsStageF, PassbandHz, StopbandAttenuationDb);
+
+				up.prepare(numChannels);
+				down.prepare(numChannels);
+
+				stageLatencyIIR[st] = (up.getLatency() + down.getLatency()) * .5f / static_cast<float>(stageFactor);
+			}
+			{
+				auto& up = filtersUp[st];
+				auto& down = filtersDown[st];
 
-			irUp = makeWindowedSinc(static_cast<float>(FsUp), 19000.f, true);
-			irDown = makeWindowedSinc(static_cast<float>(FsUp), 19000.f, false);
+				up.makeKernel(FsStageF, PassbandHz, true);
+				down.makeKernel(FsStageF, PassbandHz, false);
 
-			filterUp.prepare();
-			filterDown.prepare();
+				// pad the stage so that its latency is a whole number of base rate samples
+				const auto stageLatency = (up.getLatency() + down.getLatency()) / 2;
+				const auto extraDelay = (stageFactor - stageLatency % stageFactor) % stageFactor;
 
-			buffer.setSize(numChannels, blockSizeUp, false, true, false);
-			wHead.prepare(blockSizeUp, static_cast<int>(irDown.size()));
+				up.prepare(numChannels, blockSizeStage);
+				down.prepare(numChannels, blockSizeStage, extraDelay);
+
+				stageLatencyFIR[st] = (stageLatency + extraDelay) / stageFactor;
+			}
+
+			blockSizeStage *= 2;
+			buffers[st].setSize(numChannels, blockSizeStage, false, true, false);
 		}
-		else
+
+		configure();
+	}
+
+	void Oversampler::configure() noexcept
+	{
+		enbld = isEnabled();
+		lowLtncy = isLowLatency();
+		numStages = enbld ? getOrder() : 0;
+		FsUp = Fs * static_cast<double>(1 << numStages);
+		blockSizeUp = blockSize << numStages;
+
+		latency = 0;
+		auto latencyIIR = 0.f;
+		for (auto st = 0; st < numStages; ++st)
 		{
-			FsUp = Fs;
-			blockSizeUp = blockSize;
+			if (lowLtncy)
+			{
+				filtersUpIIR[st].clear();
+				filtersDownIIR[st].clear();
+				latencyIIR += stageLatencyIIR[st];
+			}
+			else
+			{
+				filtersUp[st].clear();
+				filtersDown[st].clear();
+				latency += stageLatencyFIR[st];
+			}
 		}
+
+		// the IIR's group delay is fractional and frequency dependent, so this is approximated
+		if (lowLtncy)
+			latency = static_cast<int>(std::round(latencyIIR));
 	}
 
 	AudioBuffer& Oversampler::upsample(AudioBuffer& inputBuffer) noexcept
 	{
-		enbld = isEnabled();
 		if (enbld)
 		{
 			numSamples1x = inputBuffer.getNumSamples();
-			numSamples2x = numSamples1x * 2;
 			const auto numChannels = inputBuffer.getNumChannels();
+			jassert(numSamples1x <= blockSize && numChannels <= buffers[0].getNumChannels());
 
-			buffer.setSize(numChannels, numSamples2x, true, false, true);
-
-			auto samplesUp = buffer.getArrayOfWritePointers();
-			const auto samplesIn = inputBuffer.getArrayOfReadPointers();
-
-			wHead(numSamples2x);
-
-			zeroStuff(samplesUp, samplesIn, numChannels, numSamples1x);
-			filterUp.processBlock(samplesUp, numChannels, numSamples2x);
+			auto bufferIn = &inputBuffer;
+			auto numSamplesIn = numSamples1x;
+			for (auto st = 0; st < numStages; ++st)
+			{
+				auto& bufferUp = views[st];
+				bufferUp.setDataToReferTo(buffers[st].getArrayOfWritePointers(), numChannels, numSamplesIn * 2);
+
+				if (lowLtncy)
+					filtersUpIIR[st]
+					(
+						bufferUp.getArrayOfWritePointers(),
+						bufferIn->getArrayOfReadPointers(),
+						numChannels,
+						numSamplesIn
+					);
+				else
+					filtersUp[st]
+					(
+						bufferUp.getArrayOfWritePointers(),
+						bufferIn->getArrayOfReadPointers(),
+						numChannels,
+						numSamplesIn
+					);
+
+				bufferIn = &bufferUp;
+				numSamplesIn *= 2;
+			}
 
-			return buffer;
+			return *bufferIn;
 		}
 
 		return inputBuffer;
@@ -298,22 +827,54 @@ namespace audio
 	{
 		if (enbld)
 		{
-			auto samplesUp = buffer.getArrayOfWritePointers();
-			auto samplesOut = outputBuffer.getArrayOfWritePointers();
-			const auto samplesUpConst = buffer.getArrayOfReadPointers();
 			const auto numChannels = outputBuffer.getNumChannels();
 
-			// filter 2x + decimating
-			filterDown.processBlock(samplesUp, numChannels, numSamples2x);
-			decimate(samplesOut, samplesUpConst, numChannels, numSamples1x);
+			// filter + decimating, from the highest rate downwards
+			for (auto st = numStages - 1; st >= 0; --st)
+			{
+				auto& bufferOut = st == 0 ? outputBuffer : buffers[st - 1];
+
+				if (lowLtncy)
+					filtersDownIIR[st]
+					(
+						bufferOut.getArrayOfWritePointers(),
+						buffers[st].getArrayOfReadPointers(),
+						numChannels,
+						numSamples1x << st
+					);
+				else
+					filtersDown[st]
+					(
+						bufferOut.getArrayOfWritePointers(),
+						buffers[st].getArrayOfReadPointers(),
+						numChannels,
+						numSamples1x << st
+					);
+			}
 		}
 	}
 
 	const int Oversampler::getLatency() const noexcept
 	{
-		if (isEnabled())
-			return (irUp.getLatency() + irDown.getLatency()) / 2;
-		return 0;
+		return latency;
+	}
+
+	const int Oversampler::getMaxLatency() const noexcept
+	{
+		auto latencyFIR = 0;
+		auto latencyIIR = 0.f;
+		for (auto st = 0; st < MaxOrder; ++st)
+		{
+			latencyFIR += stageLatencyFIR[st];
+			latencyIIR += stageLatencyIIR[st];
+		}
+		const auto latencyIIRInt = static_cast<int>(std::round(latencyIIR));
+		return latencyFIR > latencyIIRInt ? latencyFIR : latencyIIRInt;
+	}
+
+	int Oversampler::getMaxBlockSizeUp() const noexcept
+	{
+		return blockSize << MaxOrder;
 	}
 
 	double Oversampler::getFsUp() const noexcept
@@ -336,4 +897,26 @@ namespace audio
 	{
 		enabled.store(e);
 	}
-}
\ No newline at end of file
+
+	int Oversampler::getOrder() const noexcept
+	{
+		return order.load();
+	}
+
+	/* only call this if processor is suspended! */
+	void Oversampler::setOrder(int o) noexcept
+	{
+		order.store(juce::jlimit(1, MaxOrder, o));
+	}
+
+	bool Oversampler::isLowLatency() const noexcept
+	{
+		return lowLatency.load();
+	}
+
+	/* only call this if processor is suspended! */
+	void Oversampler::setLowLatency(bool e) noexcept
+	{
+		lowLatency.store(e);
+	}
+}
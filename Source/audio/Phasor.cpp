@@ -56,6 +56,41 @@ namespace audio
 		return phase;
 	}
 
+	template<typename Float>
+	void Phasor<Float>::operator()(Float* phases, int numSamples) noexcept
+	{
+		auto p = phase.phase;
+		for (auto s = 0; s < numSamples; ++s)
+		{
+			p += inc;
+			if (p >= static_cast<Float>(1))
+				--p;
+			phases[s] = p;
+		}
+		phase.phase = p;
+	}
+
+	template<typename Float>
+	void Phasor<Float>::operator()(Float* phases, Float* incs, const Float* freqHz, int numSamples) noexcept
+	{
+		if (numSamples < 1)
+			return;
+
+		for (auto s = 0; s < numSamples; ++s)
+			incs[s] = freqHz[s] * fsInv;
+
+		auto p = phase.phase;
+		for (auto s = 0; s < numSamples; ++s)
+		{
+			p += incs[s];
+			if (p >= static_cast<Float>(1))
+				--p;
+			phases[s] = p;
+		}
+		phase.phase = p;
+		inc = incs[numSamples - 1];
+	}
+
 	template struct Phasor<float>;
 	template struct Phasor<double>;
 }
\ No newline at end of file
@@ -28,6 +28,12 @@ namespace audio
 		
 		Phase operator()() noexcept;
 
+		/* phases, numSamples (constant inc) */
+		void operator()(Float*, int) noexcept;
+
+		/* phases, incs, freqHz, numSamples (inc follows freqHz per sample) */
+		void operator()(Float*, Float*, const Float*, int) noexcept;
+
 		Phase phase;
 		Float inc, fsInv;
 	};
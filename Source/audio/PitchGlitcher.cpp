@@ -4,253 +4,135 @@
 
 namespace audio
 {
-	// PitchGlitcher::Phasor
-
-	PitchGlitcher::Phasor::Phasor() :
-		inc(),
-		buf(),
-		phase(0.f)
-	{
-	}
-
-	void PitchGlitcher::Phasor::prepare(int blockSize)
-	{
-		inc.resize(blockSize);
-		buf.resize(blockSize);
-	}
-
-	void PitchGlitcher::Phasor::operator()(int numSamples) noexcept
-	{
-		for (auto s = 0; s < numSamples; ++s)
-		{
-			buf[s] = phase;
-
-			phase += inc[s];
-			if (phase >= 1.f)
-				--phase;
-			if (phase < 0.f)
-				++phase;
-		}
-	}
-
-	const float* PitchGlitcher::Phasor::data() const noexcept
-	{
-		return buf.data();
-	}
-
-	float& PitchGlitcher::Phasor::operator[](int i) noexcept
-	{
-		return buf[i];
-	}
-
-	const float& PitchGlitcher::Phasor::operator[](int i) const noexcept
-	{
-		return buf[i];
-	}
-
 	// PitchGlitcher::Window
 
 	PitchGlitcher::Window::Window() :
 		table(),
-		buf(),
 		tableSizeF(static_cast<float>(TableSize))
 	{
 		for (auto i = 0; i < TableSize; ++i)
 		{
-			const auto x = static_cast<float>(i) / static_cast<float>(table.size());
+			const auto x = static_cast<float>(i) / tableSizeF;
 			table[i] = std::cos(x * Tau + Pi) * .5f + .5f;
 		}
+		table[TableSize] = table[0];
 	}
 
-	void PitchGlitcher::Window::prepare(int blockSize)
-	{
-		buf.resize(blockSize);
-	}
-
-	void PitchGlitcher::Window::operator()(const float* phasor, int numSamples) noexcept
-	{
-		for (auto s = 0; s < numSamples; ++s)
-		{
-			const auto idx = phasor[s] * tableSizeF;
-			buf[s] = interpolate::lerp(table.data(), idx, TableSize);
-		}
-	}
-
-	const float* PitchGlitcher::Window::data() const noexcept
-	{
-		return buf.data();
-	}
-
-	// PitchGlitcher::ReadHead
-
-	PitchGlitcher::ReadHead::ReadHead() :
-		buf(),
-		sizeF(0.f)
-	{}
-
-	void PitchGlitcher::ReadHead::prepare(int blockSize, float _sizeF) noexcept
-	{
-		buf.resize(blockSize);
-		sizeF = _sizeF;
-	}
-
-	void PitchGlitcher::ReadHead::operator()(const int* wHead, const float* modulator, int numSamples) noexcept
-	{
-		for (auto s = 0; s < numSamples; ++s)
-		{
-			auto r = static_cast<float>(wHead[s]) - modulator[s] * sizeF;
-			if (r < 0.)
-				r += sizeF;
-			buf[s] = r;
-		}
-	}
-
-	const float* PitchGlitcher::ReadHead::data() const noexcept
+	void PitchGlitcher::Window::operator()(float* dest, const float* phases, int numSamples) const noexcept
 	{
-		return buf.data();
+		interpolate::lerp(dest, table.data(), phases, tableSizeF, numSamples);
 	}
 
-	// PitchGlitcher::Delay
+	// PitchGlitcher::Voices
 
-	PitchGlitcher::Delay::Delay() :
+	PitchGlitcher::Voices::Voices() :
+		window(),
 		ringBuffer(),
+		phase(),
+		ratio(),
+		ratioDest(),
+		active(),
 
-		sizeF(0.f),
-		size(0)
+		smoothX(0.f),
+		numChannelsPrev(0),
+		numVoicesPrev(0)
 	{
+		phase.fill(0.f);
+		ratio.fill(1.f);
+		ratioDest.fill(1.f);
+		active.fill(0.f);
 	}
 
-	void PitchGlitcher::Delay::prepare(int _size)
+	void PitchGlitcher::Voices::prepare(float Fs, int size)
 	{
-		size = _size;
-		for (auto& ch : ringBuffer)
-			ch.resize(size + 4, 0.f);
+		ringBuffer.prepare(2 * NumVoices + NumLanes - NumVoices, size);
+		ringBuffer.clear();
+		numChannelsPrev = numVoicesPrev = 0;
+
+		smoothX = std::exp(-1.f / msInSamples(70.f, Fs));
 	}
 
-	void PitchGlitcher::Delay::operator()(float* const* samples, int numChannels, int numSamples,
-		const int* wHead, const float* readHead/*[0, size[*/,
-		const float* window, float feedback/*[-1,1]*/) noexcept
+	void PitchGlitcher::Voices::operator()(float* const* samples, int numChannels, int numSamples,
+		const float* grainBuf, const float* tunes, int numVoices,
+		float feedback) noexcept
 	{
-		for (auto ch = 0; ch < numChannels; ++ch)
+		for (auto i = 0; i < numVoices; ++i)
 		{
-			auto smpls = samples[ch];
-			auto ring = ringBuffer[ch].data();
-
-			for (auto s = 0; s < numSamples; ++s)
-			{
-				const auto w = wHead[s];
-				const auto r = readHead[s];
-				const auto wndw = window[s];
-
-				const auto sOut = interpolate::lerp(ring, r, size) * wndw;
-				const auto sIn = smpls[s] + sOut * feedback;
-
-				ring[w] = sIn;
-				smpls[s] = sOut;
-			}
+			active[i] = 1.f;
+			ratioDest[i] = std::pow(2.f, tunes[i] * Inv12);
 		}
-	}
-
-	// PitchGlitcher::Shifter
-
-	PitchGlitcher::Shifter::Shifter() :
-		audioBuffer(),
-
-		phasor(),
-		window(),
-		readHead(),
-		delay(),
-
-		tuneParam(0.f),
-
-		sizeInv(1.f),
-		Fs(0.f)
-	{
-	}
-
-	void PitchGlitcher::Shifter::prepare(float _Fs, int blockSize, int size)
-	{
-		Fs = _Fs;
-
-		audioBuffer.setSize(2, blockSize, true, true, false);
-
-		phasor.prepare(blockSize);
-		window.prepare(blockSize);
-		readHead.prepare(blockSize, static_cast<float>(size));
-		delay.prepare(size);
-
-		sizeInv = 1.f / static_cast<float>(size);
-
-		tuneParam.prepare(Fs, blockSize, 70.f);
-	}
-
-	void PitchGlitcher::Shifter::operator()(float* const* samples, int numChannels, int numSamples,
-		const int* wHead, const float* grainBuf,
-		float tune, float feedback) noexcept
-	{
-		for (auto ch = 0; ch < numChannels; ++ch)
+		for (auto i = numVoices; i < NumLanes; ++i)
 		{
-			auto buffer = audioBuffer.getWritePointer(ch);
-			const auto smpls = samples[ch];
-
-			SIMD::copy(buffer, smpls, numSamples);
+			active[i] = 0.f;
+			ratioDest[i] = 1.f;
 		}
+		const auto gain = 1.f / std::sqrt(static_cast<float>(numVoices));
+		const auto numVecs = (numVoices + Vec4::NumLanes - 1) / Vec4::NumLanes;
+		const auto numLanes = numVecs * Vec4::NumLanes;
 
-		const auto tuneN = tune * Inv12;
-		const auto tuneBuf = tuneParam(std::pow(2.f, tuneN), numSamples);
-
-		for (auto s = 0; s < numSamples; ++s)
-			phasor.inc[s] = (1.f - tuneBuf[s]) / grainBuf[s];
-
-		phasor(numSamples);
+		// voices and channels that weren't written since the last call hold old audio
+		for (auto ch = 0; ch < numChannels; ++ch)
+			for (auto i = ch < numChannelsPrev ? numVoicesPrev : 0; i < numVoices; ++i)
+				ringBuffer.clear(ch * NumVoices + i);
+		numChannelsPrev = numChannels;
+		numVoicesPrev = numVoices;
 
-		window(phasor.data(), numSamples);
+		const Vec4 one(1.f), smoothXV(smoothX), feedbackV(feedback);
+		alignas(16) std::array<float, NumLanes> wndw, delay, ringIn;
 
 		for (auto s = 0; s < numSamples; ++s)
-			phasor[s] *= grainBuf[s] * sizeInv;
+		{
+			const Vec4 grain(grainBuf[s]);
 
-		readHead(wHead, phasor.data(), numSamples);
+			window(wndw.data(), phase.data(), numLanes);
 
-		delay
-		(
-			audioBuffer.getArrayOfWritePointers(),
-			numChannels,
-			numSamples,
-			wHead,
-			readHead.data(),
-			window.data(),
-			feedback
-		);
-	}
+			for (auto v = 0; v < numVecs; ++v)
+			{
+				const auto i = v * Vec4::NumLanes;
 
-	void PitchGlitcher::Shifter::copyTo(float* const* samples, int numChannels, int numSamples) noexcept
-	{
-		for (auto ch = 0; ch < numChannels; ++ch)
-		{
-			const auto buffer = audioBuffer.getReadPointer(ch);
-			auto smpls = samples[ch];
+				const auto dest = Vec4::load(ratioDest.data() + i);
+				const auto r = dest + smoothXV * (Vec4::load(ratio.data() + i) - dest);
+				r.store(ratio.data() + i);
 
-			SIMD::copy(smpls, buffer, numSamples);
-		}
-	}
+				// the read head trails the write head by up to one grain
+				auto p = Vec4::load(phase.data() + i);
+				(p * grain).store(delay.data() + i);
 
-	void PitchGlitcher::Shifter::addTo(float* const* samples, int numChannels, int numSamples) noexcept
-	{
-		for (auto ch = 0; ch < numChannels; ++ch)
-		{
-			const auto buffer = audioBuffer.getReadPointer(ch);
-			auto smpls = samples[ch];
+				p += (one - r) / grain;
+				p -= Vec4::floor(p);
+				p.store(phase.data() + i);
 
-			SIMD::add(smpls, buffer, numSamples);
+				(Vec4::load(wndw.data() + i) * Vec4::load(active.data() + i)).store(wndw.data() + i);
+			}
+
+			for (auto ch = 0; ch < numChannels; ++ch)
+			{
+				const auto ringCh = ch * NumVoices;
+				const Vec4 x(samples[ch][s]);
+
+				// each voice feeds back into its own channel only
+				Vec4 sum(0.f);
+				for (auto v = 0; v < numVecs; ++v)
+				{
+					const auto i = v * Vec4::NumLanes;
+					const auto tap = ringBuffer.read(ringCh + i, s, Vec4::load(delay.data() + i));
+					const auto y = tap * Vec4::load(wndw.data() + i);
+					(x + y * feedbackV).store(ringIn.data() + i);
+					sum += y;
+				}
+
+				for (auto i = 0; i < numVoices; ++i)
+					ringBuffer.write(ringCh + i, s, ringIn[i]);
+				samples[ch][s] = sum.reduceAdd() * gain;
+			}
 		}
+		ringBuffer.advance(numSamples);
 	}
 
 	// PitchGlitcher
 
 	PitchGlitcher::PitchGlitcher() :
-		wHead(),
-
-		shifter(),
+		voices(),
 
 		grainParam(20.f),
 
@@ -263,10 +145,7 @@ namespace audio
 
 		const auto size = static_cast<int>(msInSamples(static_cast<float>(PPDPitchShifterSizeMs), Fs));
 
-		wHead.prepare(_blockSize, size);
-
-		for (auto& s : shifter)
-			s.prepare(Fs, _blockSize, size);
+		voices.prepare(Fs, size);
 
 		grainParam.prepare(Fs, _blockSize, 140.f);
 	}
@@ -275,41 +154,27 @@ namespace audio
 		float tuneP/*[-24,24]*/, float grainSizeP/*[0, sizeF]*/, float feedbackP/*[0,1]*/,
 		int numVoicesP/*[1,NumVoices]*/, float spreadTuneP/*[0,1]*/) noexcept
 	{
-		wHead(numSamples);
-
-		const auto grainBuf = grainParam(msInSamples(grainSizeP, Fs), numSamples);
-
-		shifter[0]
-		(
-			samples, numChannels, numSamples,
-			wHead.data(), grainBuf,
-			tuneP, feedbackP
-			);
+		const auto grainSize = msInSamples(grainSizeP, Fs);
+		const auto grainBuf = grainParam(grainSize, numSamples);
+		if (!grainParam.smoothing)
+			SIMD::fill(grainBuf, grainSize, numSamples);
 
+		std::array<float, NumLanes> tunes;
+		tunes.fill(tuneP);
 		for (auto i = 1; i < numVoicesP; ++i)
 		{
-			auto& shftr = shifter[i];
-
 			const auto flip = i % 2 == 0 ? 1.f : -1.f;
 			const auto x = static_cast<float>(i) / numVoicesP;
 
-			const auto spreadTune = x * spreadTuneP * flip;
-
-			shftr
-			(
-				samples, numChannels, numSamples,
-				wHead.data(), grainBuf,
-				tuneP + spreadTune, feedbackP
-			);
+			tunes[i] = tuneP + x * spreadTuneP * flip;
 		}
 
-		shifter[0].copyTo(samples, numChannels, numSamples);
-		for (auto i = 1; i < numVoicesP; ++i)
-			shifter[i].addTo(samples, numChannels, numSamples);
-
-		const auto gain = 1.f / std::sqrt(static_cast<float>(numVoicesP));
-		for (auto ch = 0; ch < numChannels; ++ch)
-			SIMD::multiply(samples[ch], gain, numSamples);
+		voices
+		(
+			samples, numChannels, numSamples,
+			grainBuf, tunes.data(),
+			numVoicesP, feedbackP
+		);
 	}
 }
 
@@ -1,7 +1,8 @@
 #pragma once
-#include "WHead.h"
+#include "RingBuffer.h"
 #include "PRM.h"
 #include "../arch/Interpolation.h"
+#include "../arch/Vec4.h"
 #include "AudioUtils.h"
 
 #include <array>
@@ -15,26 +16,10 @@ namespace audio
 		static constexpr int NumVoices = PPDPitchShifterNumVoices;
 		static constexpr float Inv12 = 1.f / 12.f;
 
-		struct Phasor
-		{
-			Phasor();
-
-			/*blockSize*/
-			void prepare(int);
-
-			/*numSamples*/
-			void operator()(int) noexcept;
-
-			const float* data() const noexcept;
-
-			float& operator[](int i) noexcept;
-			const float& operator[](int i) const noexcept;
-
-			std::vector<float> inc;
-		protected:
-			std::vector<float> buf;
-			float phase;
-		};
+		using Vec4 = simd::Vec4;
+		// voices are processed in simd lanes, vectors without active voices are skipped
+		static constexpr int NumVecs = (NumVoices + Vec4::NumLanes - 1) / Vec4::NumLanes;
+		static constexpr int NumLanes = NumVecs * Vec4::NumLanes;
 
 		struct Window
 		{
@@ -42,81 +27,42 @@ namespace audio
 
 			Window();
 
-			/*blockSize*/
-			void prepare(int);
-
-			/*phasor, numSamples*/
-			void operator()(const float*, int) noexcept;
-
-			const float* data() const noexcept;
+			/* dest, phases, numSamples */
+			void operator()(float*, const float*, int) const noexcept;
 
 		protected:
-			std::array<float, TableSize> table;
-			std::vector<float> buf;
+			std::array<float, TableSize + 1> table;
 			float tableSizeF;
 		};
 
-		struct ReadHead
-		{
-			ReadHead();
-
-			/*blockSize, sizeF*/
-			void prepare(int, float) noexcept;
-
-			/*wHead, modulator, numSamples*/
-			void operator()(const int*, const float*, int) noexcept;
-
-			const float* data() const noexcept;
-
-		protected:
-			std::vector<float> buf;
-			float sizeF;
-		};
-
-		struct Delay
+		/*
+		* all grains in structure-of-arrays form, one voice per simd lane.
+		every voice has its own ring buffer channel and feedback path,
+		channel ch * NumVoices + voice, so the taps can be read lane-wise.
+		the last vector's lanes above NumVoices read into the next channel's
+		voices (or the padding after the last one) and are muted.
+		only active voices are written. a voice that becomes active again
+		starts from a cleared channel.
+		*/
+		struct Voices
 		{
-			Delay();
-
-			/* size */
-			void prepare(int);
+			using Interpolator = interpolate::CubicHermiteSpline;
 
-			/* samples, numChannels, numSamples, wHead, readHead [0, size[, window, feedback[-1,1] */
-			void operator()(float* const*, int, int, const int*, const float*, const float*, float) noexcept;
+			Voices();
 
-		protected:
-			std::array<std::vector<float>, 2> ringBuffer;
-
-			float sizeF;
-			int size;
-		};
+			/* Fs, size */
+			void prepare(float, int);
 
-		struct Shifter
-		{
-			Shifter();
-
-			/* Fs, blockSize, size */
-			void prepare(float, int, int);
-
-			/* samples, numChannels, numSamples, wHead, grainBuf, tune, feedback */
-			void operator()(float* const*, int, int, const int*, const float*, float, float) noexcept;
-
-			/* samples, numChannels, numSamples */
-			void copyTo(float* const*, int, int) noexcept;
-
-			/* samples, numChannels, numSamples */
-			void addTo(float* const*, int, int) noexcept;
+			/* samples, numChannels, numSamples, grainBuf, tunes (semitones per voice), numVoices, feedback[0,1] */
+			void operator()(float* const*, int, int, const float*, const float*, int, float) noexcept;
 
 		protected:
-			AudioBuffer audioBuffer;
-
-			Phasor phasor;
 			Window window;
-			ReadHead readHead;
-			Delay delay;
-
-			PRM tuneParam;
+			RingBuffer<Interpolator> ringBuffer;
+			alignas(16) std::array<float, NumLanes> phase, ratio, ratioDest, active;
 
-			float sizeInv, Fs;
+			float smoothX;
+			int numChannelsPrev, numVoicesPrev;
 		};
 
 	public:
@@ -129,9 +75,7 @@ namespace audio
 		void operator()(float* const*, int, int, float, float, float, int, float) noexcept;
 
 	protected:
-		WHead wHead;
-		
-		std::array<Shifter, NumVoices> shifter;
+		Voices voices;
 
 		PRM grainParam;
 
@@ -143,8 +87,6 @@ namespace audio
 
 /*
 
-voice 1 need no copy to self buffer
-
 alter pitch per voice instead of grain size
 
 */
\ No newline at end of file
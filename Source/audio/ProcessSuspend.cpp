@@ -2,8 +2,8 @@
 
 namespace audio
 {
-	ProcessSuspender::ProcessSuspender(juce::AudioProcessor& p) :
-		processor(p),
+	ProcessSuspender::ProcessSuspender(Suspendable& s) :
+		suspendable(s),
 		stage(Stage::Running)
 	{
 
@@ -31,11 +31,7 @@ namespace audio
 		if (stg == Stage::Suspending)
 		{
 			stage.store(Stage::Suspended);
-			processor.prepareToPlay
-			(
-				processor.getSampleRate(),
-				processor.getBlockSize()
-			);
+			suspendable.prepareSuspended();
 		}
 
 		return true;
@@ -13,7 +13,19 @@ namespace audio
 			NumStages
 		};
 
-		ProcessSuspender(juce::AudioProcessor&);
+		struct Suspendable
+		{
+			virtual ~Suspendable() = default;
+
+			/*
+			* audio thread, reconfigures the processor while it is suspended.
+			must not allocate, so everything it touches is sized for the worst case
+			in prepareToPlay. calls ProcessSuspender::prepareToPlay when done.
+			*/
+			virtual void prepareSuspended() noexcept = 0;
+		};
+
+		ProcessSuspender(Suspendable&);
 
 		void suspend() noexcept;
 
@@ -23,7 +35,7 @@ namespace audio
 		void prepareToPlay() noexcept;
 
 	protected:
-		juce::AudioProcessor& processor;
+		Suspendable& suspendable;
 		std::atomic<Stage> stage;
 	};
 }
@@ -0,0 +1,237 @@
+#include "Profiler.h"
+#include <bit>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace audio
+{
+	/* cycles, 4 bins per octave, exact below 8 */
+	static int cyclesToBin(Profiler::Cycles c) noexcept
+	{
+		if (c < 8)
+			return static_cast<int>(c);
+		const auto msb = static_cast<int>(std::bit_width(c));
+		return (msb - 2) * 4 + static_cast<int>((c >> (msb - 3)) & 3);
+	}
+
+	/* bin, returns the centre of the bin in cycles */
+	static Profiler::Cycles binToCycles(int bin) noexcept
+	{
+		if (bin < 8)
+			return static_cast<Profiler::Cycles>(bin);
+		const auto shift = bin / 4 - 1;
+		const auto lower = static_cast<Profiler::Cycles>(4 + bin % 4) << shift;
+		return lower + (static_cast<Profiler::Cycles>(1) << shift) / 2;
+	}
+
+	// Histogram
+
+	Profiler::Histogram::Histogram() :
+		bins(),
+		max(0),
+		count(0),
+		window(),
+		windowIdx(0)
+	{
+		clear();
+	}
+
+	void Profiler::Histogram::clear() noexcept
+	{
+		for (auto& b : bins)
+			b.store(0);
+		max.store(0);
+		count.store(0);
+		window.fill(0);
+		windowIdx = 0;
+	}
+
+	void Profiler::Histogram::add(Cycles c) noexcept
+	{
+		const auto bin = cyclesToBin(c);
+		const auto n = count.load(std::memory_order_relaxed);
+
+		// forget the oldest entry once the window is full
+		if (n == WindowSize)
+			bins[window[windowIdx]].fetch_sub(1, std::memory_order_relaxed);
+		else
+			count.store(n + 1, std::memory_order_relaxed);
+
+		bins[bin].fetch_add(1, std::memory_order_relaxed);
+		window[windowIdx] = static_cast<unsigned char>(bin);
+		windowIdx = (windowIdx + 1) & (WindowSize - 1);
+
+		if (c > max.load(std::memory_order_relaxed))
+			max.store(c, std::memory_order_relaxed);
+	}
+
+	Profiler::Cycles Profiler::Histogram::getPercentile(double p) const noexcept
+	{
+		std::array<int, NumBins> snapshot;
+		auto total = 0;
+		for (auto i = 0; i < NumBins; ++i)
+		{
+			snapshot[i] = std::max(bins[i].load(std::memory_order_relaxed), 0);
+			total += snapshot[i];
+		}
+		if (total == 0)
+			return 0;
+
+		const auto target = static_cast<int>(std::ceil(p * total));
+		auto sum = 0;
+		for (auto i = 0; i < NumBins; ++i)
+		{
+			sum += snapshot[i];
+			if (sum >= target)
+				return binToCycles(i);
+		}
+		return binToCycles(NumBins - 1);
+	}
+
+	// Profiler
+
+	Profiler::Cycles Profiler::now() noexcept
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#elif defined(__aarch64__)
+		Cycles c;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(c));
+		return c;
+#else
+		return static_cast<Cycles>(juce::Time::getHighResolutionTicks());
+#endif
+	}
+
+	Profiler::String Profiler::toString(Stage stage)
+	{
+		switch (stage)
+		{
+		case Stage::Macro: return "Macro";
+		case Stage::MIDI: return "MIDI";
+		case Stage::SaveDry: return "Save Dry";
+		case Stage::MidSideEncode: return "M/S Encode";
+		case Stage::PreUpscaled: return "Pre Upscaled";
+		case Stage::Upsample: return "Upsample";
+		case Stage::Upsampled: return "Upsampled";
+		case Stage::Downsample: return "Downsample";
+		case Stage::MidSideDecode: return "M/S Decode";
+		case Stage::GainOut: return "Gain Out";
+		case Stage::TuningEditor: return "Tuning Editor";
+		case Stage::Clipper: return "Clipper";
+		case Stage::Meters: return "Meters";
+		case Stage::Mix: return "Mix";
+		case Stage::Block: return "Block";
+		default: return "";
+		}
+	}
+
+	Profiler::Profiler() :
+		stages(),
+		deadline(),
+		Fs(1.),
+		blockStart(0),
+		lastMark(0),
+		calibrationCycles(now()),
+		calibrationTicks(juce::Time::getHighResolutionTicks()),
+		cyclesPerSec(0.)
+	{}
+
+	void Profiler::prepare(double sampleRate)
+	{
+		Fs.store(sampleRate);
+		for (auto& stage : stages)
+			stage.clear();
+		deadline.clear();
+	}
+
+	void Profiler::beginBlock() noexcept
+	{
+		blockStart = now();
+		lastMark = blockStart;
+	}
+
+	void Profiler::mark(Stage stage) noexcept
+	{
+		const auto t = now();
+		stages[static_cast<int>(stage)].add(t - lastMark);
+		lastMark = t;
+	}
+
+	void Profiler::endBlock(int numSamples) noexcept
+	{
+		const auto elapsed = now() - blockStart;
+		stages[static_cast<int>(Stage::Block)].add(elapsed);
+		// cycles per sample, turned into a ratio on the message thread
+		deadline.add(elapsed / static_cast<Cycles>(numSamples));
+	}
+
+	Profiler::Stats Profiler::getStats(Stage stage) const
+	{
+		const auto& h = stages[static_cast<int>(stage)];
+		const auto msPerCycle = 1000. / getCyclesPerSec();
+		return
+		{
+			static_cast<double>(h.getPercentile(.5)) * msPerCycle,
+			static_cast<double>(h.getPercentile(.99)) * msPerCycle,
+			static_cast<double>(h.max.load()) * msPerCycle,
+			h.count.load()
+		};
+	}
+
+	Profiler::Stats Profiler::getDeadlineRatio() const
+	{
+		const auto ratioPerCycle = Fs.load() / getCyclesPerSec();
+		return
+		{
+			static_cast<double>(deadline.getPercentile(.5)) * ratioPerCycle,
+			static_cast<double>(deadline.getPercentile(.99)) * ratioPerCycle,
+			static_cast<double>(deadline.max.load()) * ratioPerCycle,
+			deadline.count.load()
+		};
+	}
+
+	Profiler::String Profiler::toString() const
+	{
+		String str("stage: p50 / p99 / max (ms)\n");
+		for (auto s = 0; s < NumStages; ++s)
+		{
+			const auto stage = static_cast<Stage>(s);
+			const auto stats = getStats(stage);
+			if (stats.count == 0)
+				continue;
+			str += toString(stage) + ": "
+				+ String(stats.p50, 4) + " / "
+				+ String(stats.p99, 4) + " / "
+				+ String(stats.max, 4) + "\n";
+		}
+		const auto ratio = getDeadlineRatio();
+		str += "deadline: "
+			+ String(ratio.p50 * 100., 1) + "% / "
+			+ String(ratio.p99 * 100., 1) + "% / "
+			+ String(ratio.max * 100., 1) + "%\n";
+		return str;
+	}
+
+	bool Profiler::dump(const juce::File& file) const
+	{
+		return file.replaceWithText(toString());
+	}
+
+	double Profiler::getCyclesPerSec() const
+	{
+		// the cycle counter is calibrated against the high resolution clock
+		const auto ticks = juce::Time::getHighResolutionTicks() - calibrationTicks;
+		const auto ticksPerSec = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+		const auto secs = static_cast<double>(ticks) / ticksPerSec;
+		if (secs > .05)
+			cyclesPerSec = static_cast<double>(now() - calibrationCycles) / secs;
+		return cyclesPerSec > 0. ? cyclesPerSec : 1e9;
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+namespace audio
+{
+	/*
+	* lock-free timings of processBlock's stages.
+	the audio thread stamps a cycle counter after each stage and adds the
+	elapsed cycles to a rolling histogram of that stage (4 bins per octave).
+	the message thread reads percentiles from the histograms.
+	the processor only owns one if PPDHasProfiler is true.
+	*/
+	struct Profiler
+	{
+		using Cycles = unsigned long long;
+		using String = juce::String;
+
+		enum class Stage
+		{
+			Macro,
+			MIDI,
+			SaveDry,
+			MidSideEncode,
+			PreUpscaled,
+			Upsample,
+			Upsampled,
+			Downsample,
+			MidSideDecode,
+			GainOut,
+			TuningEditor,
+			Clipper,
+			Meters,
+			Mix,
+			Block,
+			NumStages
+		};
+		static constexpr int NumStages = static_cast<int>(Stage::NumStages);
+		static constexpr int NumBins = 256;
+		static constexpr int WindowSize = 1 << 10;
+
+		/* ms for stages, ratio of the block's duration for the deadline */
+		struct Stats
+		{
+			double p50, p99, max;
+			int count;
+		};
+
+		static Cycles now() noexcept;
+
+		static String toString(Stage);
+
+		Profiler();
+
+		/* sampleRate (resets all statistics) */
+		void prepare(double);
+
+		void beginBlock() noexcept;
+
+		/* marks the end of a stage */
+		void mark(Stage) noexcept;
+
+		/* numSamples */
+		void endBlock(int) noexcept;
+
+		/* message thread */
+		Stats getStats(Stage) const;
+
+		/* time used vs. numSamples / Fs (message thread) */
+		Stats getDeadlineRatio() const;
+
+		/* message thread */
+		String toString() const;
+
+		/* message thread */
+		bool dump(const juce::File&) const;
+
+	protected:
+		struct Histogram
+		{
+			Histogram();
+
+			void clear() noexcept;
+
+			/* audio thread */
+			void add(Cycles) noexcept;
+
+			/* percentile [0, 1] */
+			Cycles getPercentile(double) const noexcept;
+
+			std::array<std::atomic<int>, NumBins> bins;
+			std::atomic<Cycles> max;
+			std::atomic<int> count;
+			std::array<unsigned char, WindowSize> window;
+			int windowIdx;
+		};
+
+		std::array<Histogram, NumStages> stages;
+		Histogram deadline;
+		std::atomic<double> Fs;
+		Cycles blockStart, lastMark;
+
+		Cycles calibrationCycles;
+		juce::int64 calibrationTicks;
+		mutable double cyclesPerSec;
+
+		double getCyclesPerSec() const;
+	};
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "AudioUtils.h"
+#include "../arch/Interpolation.h"
+#include "../arch/Vec4.h"
+#include <bit>
+
+namespace audio
+{
+	/*
+	* multichannel delay line with power-of-two capacity.
+	positions wrap by masking and the interpolator's guard samples are
+	mirrored on write, so neither reads nor writes divide or branch.
+	reads and writes are addressed relative to the write position,
+	which advances once per block.
+	fractional reads look NumPost samples ahead of their integer position,
+	so their delay is clamped to at least MinDelay. otherwise they would
+	touch the sample being written and ones from a whole capacity ago.
+	*/
+	template<class Interpolator>
+	struct RingBuffer
+	{
+		static constexpr float MinDelay = static_cast<float>(Interpolator::NumPost);
+
+		RingBuffer() :
+			buffer(),
+			capacity(1),
+			mask(0),
+			writePos(0)
+		{}
+
+		/* numChannels, maxDelay (longest delay in samples that will be read) */
+		void prepare(int numChannels, int maxDelay)
+		{
+			// the longest read spans NumPre samples behind and NumPost ahead of maxDelay,
+			// +1 for the sample being written
+			const auto minCapacity = maxDelay + Interpolator::NumPre + Interpolator::NumPost + 1;
+			capacity = static_cast<int>(std::bit_ceil(static_cast<unsigned int>(minCapacity)));
+			mask = capacity - 1;
+			writePos &= mask;
+			buffer.setSize(numChannels, Interpolator::NumPre + capacity + Interpolator::NumPost, false, true, false);
+		}
+
+		void clear() noexcept
+		{
+			buffer.clear();
+		}
+
+		/* ch */
+		void clear(int ch) noexcept
+		{
+			SIMD::clear(buffer.getWritePointer(ch), buffer.getNumSamples());
+		}
+
+		int getCapacity() const noexcept
+		{
+			return capacity;
+		}
+
+		/* ch, s, x. writes to write position + s */
+		void write(int ch, int s, float x) noexcept
+		{
+			auto ring = buffer.getWritePointer(ch) + Interpolator::NumPre;
+			interpolate::writeGuarded<Interpolator>(ring, capacity, (writePos + s) & mask, x);
+		}
+
+		/* ch, s, delay [MinDelay, maxDelay]. delay samples behind write position + s */
+		float read(int ch, int s, float delay) const noexcept
+		{
+			delay = delay < MinDelay ? MinDelay : delay;
+			const auto ring = buffer.getReadPointer(ch) + Interpolator::NumPre;
+			const auto d = static_cast<int>(delay);
+			// i + t lands on write position + s - delay, with t ]0, 1]
+			const auto i = (writePos + s - d - 1) & mask;
+			const auto t = 1.f - (delay - static_cast<float>(d));
+			return Interpolator::read(ring, i, t);
+		}
+
+		/* ch, s, delays [MinDelay, maxDelay]. lane i reads channel ch + i
+		the positions and the interpolation run in simd lanes, only the loads are scalar.
+		needs an Interpolator whose read also takes simd::Vec4 (Lerp, CubicHermiteSpline) */
+		simd::Vec4 read(int ch, int s, const simd::Vec4& delay) const noexcept
+		{
+			using Vec4 = simd::Vec4;
+			constexpr auto NumLanes = Vec4::NumLanes;
+			constexpr auto NumPoints = Interpolator::NumPre + 1 + Interpolator::NumPost;
+
+			const auto dly = Vec4::max(delay, Vec4(MinDelay));
+			int d[NumLanes];
+			const auto t = Vec4(1.f) - (dly - dly.truncate(d));
+
+			float points[NumPoints][NumLanes];
+			for (auto l = 0; l < NumLanes; ++l)
+			{
+				const auto ring = buffer.getReadPointer(ch + l) + Interpolator::NumPre;
+				const auto i = (writePos + s - d[l] - 1) & mask;
+				for (auto p = 0; p < NumPoints; ++p)
+					points[p][l] = ring[i - Interpolator::NumPre + p];
+			}
+
+			Vec4 pointsV[NumPoints];
+			for (auto p = 0; p < NumPoints; ++p)
+				pointsV[p] = Vec4::load(points[p]);
+			return Interpolator::read(pointsV, Interpolator::NumPre, t);
+		}
+
+		/* ch, s, delay [0, capacity[ */
+		float read(int ch, int s, int delay) const noexcept
+		{
+			const auto ring = buffer.getReadPointer(ch) + Interpolator::NumPre;
+			return ring[(writePos + s - delay) & mask];
+		}
+
+		/* numSamples */
+		void advance(int numSamples) noexcept
+		{
+			writePos = (writePos + numSamples) & mask;
+		}
+
+	protected:
+		AudioBuffer buffer;
+		int capacity, mask, writePos;
+	};
+}
@@ -8,11 +8,9 @@ namespace audio
 		fft(Order),
 		fifo(),
 		window(),
-		buffer(),
-		ready(false),
+		frames(),
 		idx(0)
 	{
-		SIMD::clear(buffer.data(), Size2);
 		SIMD::clear(fifo.data(), Size2);
 
 		// gaussian window
@@ -59,12 +57,16 @@ namespace audio
 			if (idx == Size)
 			{
 				const auto wndw = window.data();
-				auto buf = buffer.data();
 
 				SIMD::multiply(fif, wndw, Size);
 				fft.performRealOnlyForwardTransform(fif, true);
-				SIMD::copy(buf, fif, Size);
-				ready.store(true);
+				// dropped if the gui hasn't caught up with the last frames
+				auto frame = frames.beginWrite();
+				if (frame != nullptr)
+				{
+					SIMD::copy(frame->data(), fif, Size);
+					frames.endWrite();
+				}
 				idx = 0;
 			}
 		}
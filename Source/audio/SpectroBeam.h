@@ -1,5 +1,6 @@
 #pragma once
 #include "AudioUtils.h"
+#include "FrameQueue.h"
 #include <juce_dsp/juce_dsp.h>
 
 namespace audio
@@ -12,10 +13,12 @@ namespace audio
 		static constexpr size_t SizeHalf = Size / 2;
 		static constexpr float SizeF = static_cast<float>(Size);
 		static constexpr float SizeInv = 1.f / SizeF;
+		static constexpr int NumFrames = 4;
 		
 		using FFT = juce::dsp::FFT;
 		using Fifo = std::array<float, Size>;
 		using Fifo2 = std::array<float, Size2>;
+		using Frames = FrameQueue<Fifo, NumFrames>;
 
 		SpectroBeam();
 
@@ -34,8 +37,7 @@ namespace audio
 		Fifo2 fifo;
 		Fifo window;
 	public:
-		Fifo2 buffer;
-		std::atomic<bool> ready;
+		Frames frames;
 	protected:
 		int idx;
 	};
@@ -21,8 +21,13 @@ namespace audio
 
 	void WHead::operator()(int numSamples) noexcept
 	{
-		for (auto s = 0; s < numSamples; ++s, wHead = (wHead + 1) % delaySize)
+		for (auto s = 0; s < numSamples; ++s)
+		{
 			buf[s] = wHead;
+			// compiles to a select instead of a division
+			++wHead;
+			wHead = wHead == delaySize ? 0 : wHead;
+		}
 	}
 
 	int WHead::operator[](int i) const noexcept
@@ -1,17 +1,22 @@
 #include "WaveTable.h"
 #include "../arch/Interpolation.h"
+#include <juce_dsp/juce_dsp.h>
+#include <thread>
 
 namespace audio
 {
 	template<size_t Size>
 	WaveTable<Size>::WaveTable() :
-		table()
+		table(),
+		mipSets(),
+		current(0),
+		reading(-1)
 	{
 		create([](float x) { return std::cos(x * Pi); });
 	}
 
 	template<size_t Size>
-	void WaveTable<Size>::create(const Func& func) noexcept
+	void WaveTable<Size>::create(const Func& func)
 	{
 		auto x = -1.f + SizeInv * .5f;
 		const auto inc = 2.f * SizeInv;
@@ -19,6 +24,73 @@ namespace audio
 			table[s] = func(x);
 		for (auto i = 0; i < NumExtraSamples; ++i)
 			table[Size + i] = table[i];
+		updateMipmaps();
+	}
+
+	template<size_t Size>
+	void WaveTable<Size>::updateMipmaps()
+	{
+		juce::dsp::FFT fft(Order);
+		std::vector<float> spectrum(Size * 2, 0.f), buf(Size * 2, 0.f);
+		std::copy(table.begin(), table.begin() + Size, spectrum.begin());
+		fft.performRealOnlyForwardTransform(spectrum.data(), true);
+
+		// the audio thread only ever enters the current set, so it leaves the other one soon
+		const auto target = 1 - current.load();
+		while (reading.load() == target)
+			std::this_thread::yield();
+		auto& mips = mipSets[target];
+
+		for (auto m = 0; m < NumMips; ++m)
+		{
+			const auto mipSize = getMipSize(m);
+			const auto mipOrder = static_cast<int>(std::bit_width(static_cast<unsigned int>(mipSize))) - 1;
+			juce::dsp::FFT mipFFT(mipOrder);
+
+			// interleaved re/im, bins above the mip's highest harmonic are removed,
+			// the rest are scaled for the shorter inverse transform
+			const auto maxHarmonic = static_cast<int>(Size / 2) >> m;
+			const auto scale = static_cast<float>(mipSize) * SizeInv;
+			std::fill(buf.begin(), buf.end(), 0.f);
+			for (auto i = 0; i < (maxHarmonic + 1) * 2; ++i)
+				buf[i] = spectrum[i] * scale;
+			mipFFT.performRealOnlyInverseTransform(buf.data());
+
+			auto mip = mips.data() + getMipOffset(m);
+			std::copy(buf.begin(), buf.begin() + mipSize, mip);
+			for (auto i = 0; i < NumExtraSamples; ++i)
+				mip[mipSize + i] = mip[i];
+		}
+
+		current.store(target);
+	}
+
+	template<size_t Size>
+	const typename WaveTable<Size>::Mips& WaveTable<Size>::acquireMips() const noexcept
+	{
+		// announce the set, then make sure it wasn't swapped out in between
+		auto idx = current.load();
+		while (true)
+		{
+			reading.store(idx);
+			const auto now = current.load();
+			if (now == idx)
+				return mipSets[idx];
+			idx = now;
+		}
+	}
+
+	template<size_t Size>
+	void WaveTable<Size>::releaseMips() const noexcept
+	{
+		reading.store(-1, std::memory_order_release);
+	}
+
+	template<size_t Size>
+	float WaveTable<Size>::readMip(const Mips& mips, int m, float phase) noexcept
+	{
+		const auto idx = phase * static_cast<float>(getMipSize(m));
+		return interpolate::lerp(mips.data() + getMipOffset(m), idx);
 	}
 
 	template<size_t Size>
@@ -46,6 +118,7 @@ namespace audio
 			const auto dataSize = FullSize * sizeof(float);
 			jassert(mbSize == dataSize);
 			mb.copyTo(table.data(), 0, dataSize);
+			updateMipmaps();
 		}
 	}
 
@@ -62,6 +135,74 @@ namespace audio
 		return interpolate::lerp(table.data(), idx);
 	}
 
+	template<size_t Size>
+	float WaveTable<Size>::operator()(float phase, float inc) const noexcept
+	{
+		// mip m is alias free up to inc == 2^m / Size, so the one above mipF is.
+		// the brighter one below it fades out while its top octave starts to alias
+		const auto mipF = std::max(0.f, std::log2(std::abs(inc) * SizeF + 1e-9f));
+		const auto mipLower = static_cast<int>(mipF);
+		const auto& mips = acquireMips();
+
+		auto y = 0.f;
+		if (mipLower >= NumMips - 1)
+			y = readMip(mips, NumMips - 1, phase);
+		else
+		{
+			const auto frac = mipF - static_cast<float>(mipLower);
+			const auto a = readMip(mips, mipLower, phase);
+			const auto b = readMip(mips, mipLower + 1, phase);
+			y = a + frac * (b - a);
+		}
+
+		releaseMips();
+		return y;
+	}
+
+	template<size_t Size>
+	void WaveTable<Size>::operator()(float* dest, const float* phases, int numSamples) const noexcept
+	{
+		interpolate::lerp(dest, table.data(), phases, SizeF, numSamples);
+	}
+
+	template<size_t Size>
+	void WaveTable<Size>::operator()(float* dest, const float* phases, const float* incs, int numSamples) const noexcept
+	{
+		std::array<float, MipChunkSize> upper;
+		const auto& mips = acquireMips();
+
+		for (auto s = 0; s < numSamples; s += MipChunkSize)
+		{
+			const auto n = std::min(MipChunkSize, numSamples - s);
+			auto d = dest + s;
+			const auto p = phases + s;
+
+			// the fastest sample of the chunk decides, so no sample aliases more than that
+			auto maxInc = 0.f;
+			for (auto i = 0; i < n; ++i)
+				maxInc = std::max(maxInc, std::abs(incs[s + i]));
+
+			const auto mipF = std::max(0.f, std::log2(maxInc * SizeF + 1e-9f));
+			const auto mipLower = static_cast<int>(mipF);
+
+			if (mipLower >= NumMips - 1)
+			{
+				constexpr auto Top = NumMips - 1;
+				interpolate::lerp(d, mips.data() + getMipOffset(Top), p, static_cast<float>(getMipSize(Top)), n);
+				continue;
+			}
+
+			const auto frac = mipF - static_cast<float>(mipLower);
+			const auto mipUpper = mipLower + 1;
+			interpolate::lerp(d, mips.data() + getMipOffset(mipLower), p, static_cast<float>(getMipSize(mipLower)), n);
+			interpolate::lerp(upper.data(), mips.data() + getMipOffset(mipUpper), p, static_cast<float>(getMipSize(mipUpper)), n);
+			SIMD::multiply(d, 1.f - frac, n);
+			SIMD::addWithMultiply(d, upper.data(), frac, n);
+		}
+
+		releaseMips();
+	}
+
 	template<size_t Size>
 	float* WaveTable<Size>::data() noexcept
 	{
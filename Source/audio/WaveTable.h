@@ -1,11 +1,22 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <bit>
 #include <functional>
 #include "AudioUtils.h"
 #include "../arch/State.h"
 
 namespace audio
 {
+	/*
+	* single cycle wavetable.
+	besides the table itself there is one band-limited copy per octave
+	(mip), built by fft whenever the table changes. each mip is half as long
+	as the one below it. reading with a phase increment crossfades from the
+	first alias free mip towards the brighter one below it.
+	the mips are double buffered: updates build the set the audio thread
+	isn't reading and swap it in atomically.
+	*/
 	template<size_t Size>
 	struct WaveTable
 	{
@@ -13,13 +24,39 @@ namespace audio
 		static constexpr float SizeInv = 1.f / SizeF;
 		static constexpr int NumExtraSamples = 4;
 		static constexpr int FullSize = Size + NumExtraSamples;
+		static constexpr int Order = static_cast<int>(std::bit_width(Size)) - 1;
+		// mip m keeps the harmonics up to Size / 2 >> m
+		static constexpr int NumMips = Order;
+		static constexpr int MinMipSize = 64;
+		static constexpr int MipChunkSize = 16;
+
+		/* mip, Size >> mip samples, but at least MinMipSize */
+		static constexpr int getMipSize(int m) noexcept
+		{
+			const auto size = static_cast<int>(Size) >> m;
+			return size < MinMipSize ? MinMipSize : size;
+		}
+
+		/* mip, start of the mip in Mips */
+		static constexpr int getMipOffset(int m) noexcept
+		{
+			auto offset = 0;
+			for (auto i = 0; i < m; ++i)
+				offset += getMipSize(i) + NumExtraSamples;
+			return offset;
+		}
 
 		using Table = std::array<float, FullSize>;
+		using Mips = std::array<float, getMipOffset(NumMips)>;
 		using Func = std::function<float(float)>;
 
 		WaveTable();
 
-		void create(const Func&) noexcept;
+		/* func (allocates, message thread) */
+		void create(const Func&);
+
+		/* call after writing into data() (allocates, message thread) */
+		void updateMipmaps();
 
 		/* state, key*/
 		void savePatch(sta::State&, const String&);
@@ -33,12 +70,34 @@ namespace audio
 		/* phase */
 		float operator()(float) const noexcept;
 
+		/* phase, phase increment (freqHz / Fs). band-limited */
+		float operator()(float, float) const noexcept;
+
+		/* dest, phases, numSamples (dest may be phases) */
+		void operator()(float*, const float*, int) const noexcept;
+
+		/* dest, phases, phase increments, numSamples. band-limited,
+		the mips are chosen once per MipChunkSize samples */
+		void operator()(float*, const float*, const float*, int) const noexcept;
+
 		float* data() noexcept;
 
 		const float* data() const noexcept;
 		
 	protected:
 		Table table;
+		std::array<Mips, 2> mipSets;
+		// the set that is read from now and the one the audio thread is in (-1 if none)
+		std::atomic<int> current;
+		mutable std::atomic<int> reading;
+
+		/* marks the current set as in use for the duration of a read */
+		const Mips& acquireMips() const noexcept;
+
+		void releaseMips() const noexcept;
+
+		/* mips, mip, phase */
+		static float readMip(const Mips&, int, float) noexcept;
 	};
 
 	template<size_t Size>
@@ -81,7 +140,7 @@ namespace audio
 	inline void createWaveTableNoise(WaveTable<Size>& table)
 	{
 		juce::Random rand;
-		table.create([r = rand](float x)
+		table.create([r = rand](float) mutable
 		{
 			return r.nextFloat() * 2.f - 1.f;
 		});
@@ -0,0 +1,132 @@
+#include "WorkerPool.h"
+#include "../arch/Vec4.h"
+#if PPDVec4NEON && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace audio
+{
+	/* hints the cpu that this is a spin-wait, so it backs off the other hyperthread */
+	static inline void spinPause() noexcept
+	{
+#if PPDVec4SSE
+		_mm_pause();
+#elif PPDVec4NEON && defined(_MSC_VER)
+		__yield();
+#elif PPDVec4NEON
+		asm volatile("yield");
+#endif
+	}
+
+	// WorkerPool::Worker
+
+	WorkerPool::Worker::Worker(WorkerPool& _pool, int idx) :
+		juce::Thread("Worker " + juce::String(idx)),
+		pool(_pool)
+	{}
+
+	void WorkerPool::Worker::run()
+	{
+		// the lanes must treat denormals like the audio thread that runs the rest of them
+		const juce::ScopedNoDenormals noDenormals;
+		auto seen = pool.generation.load(std::memory_order_acquire);
+		while (!pool.exiting.load(std::memory_order_acquire))
+		{
+			pool.generation.wait(seen, std::memory_order_acquire);
+			seen = pool.generation.load(std::memory_order_acquire);
+			if (pool.exiting.load(std::memory_order_acquire))
+				return;
+			pool.work();
+		}
+	}
+
+	// WorkerPool
+
+	WorkerPool::WorkerPool() :
+		workers(),
+		numThreads(0),
+		task(nullptr),
+		context(nullptr),
+		ticket(0),
+		numDone(0),
+		generation(0),
+		exiting(false)
+	{}
+
+	WorkerPool::~WorkerPool()
+	{
+		stop();
+	}
+
+	void WorkerPool::prepare(int n)
+	{
+		n = juce::jlimit(0, MaxNumThreads, n);
+		if (n == numThreads)
+			return;
+
+		stop();
+
+		exiting.store(false);
+		numThreads = n;
+		for (auto i = 0; i < numThreads; ++i)
+		{
+			workers[i] = std::make_unique<Worker>(*this, i);
+			workers[i]->startThread(juce::Thread::Priority::highest);
+		}
+	}
+
+	int WorkerPool::getNumThreads() const noexcept
+	{
+		return numThreads;
+	}
+
+	void WorkerPool::run(Task _task, void* _context, int _numTasks) noexcept
+	{
+		if (numThreads == 0)
+		{
+			for (auto i = 0; i < _numTasks; ++i)
+				_task(_context, i);
+			return;
+		}
+
+		task = _task;
+		context = _context;
+		numDone.store(0, std::memory_order_relaxed);
+		ticket.store(static_cast<unsigned long long>(_numTasks) << 32, std::memory_order_release);
+		generation.fetch_add(1, std::memory_order_release);
+		generation.notify_all();
+
+		work();
+
+		while (numDone.load(std::memory_order_acquire) < _numTasks)
+			spinPause();
+	}
+
+	void WorkerPool::work() noexcept
+	{
+		while (true)
+		{
+			// index and count come from the same run, even for workers that woke up late
+			const auto t = ticket.fetch_add(1, std::memory_order_acq_rel);
+			const auto idx = t & 0xffffffffull;
+			if (idx >= (t >> 32))
+				return;
+			task(context, static_cast<int>(idx));
+			numDone.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	void WorkerPool::stop()
+	{
+		exiting.store(true);
+		generation.fetch_add(1, std::memory_order_release);
+		generation.notify_all();
+
+		for (auto i = 0; i < numThreads; ++i)
+		{
+			workers[i]->stopThread(1000);
+			workers[i].reset();
+		}
+		numThreads = 0;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+namespace audio
+{
+	/*
+	* small pool of worker threads for the audio thread.
+	threads are only started and stopped in prepare. run hands out
+	the tasks through atomics, works on them itself too and spin-waits
+	for the rest, so it neither locks nor allocates.
+	*/
+	class WorkerPool
+	{
+		struct Worker :
+			public juce::Thread
+		{
+			/* pool, index */
+			Worker(WorkerPool&, int);
+
+			void run() override;
+
+		protected:
+			WorkerPool& pool;
+		};
+	public:
+		static constexpr int MaxNumThreads = 7;
+
+		/* context, taskIdx */
+		using Task = void(*)(void*, int);
+
+		WorkerPool();
+
+		~WorkerPool();
+
+		/*
+		* numThreads [0, MaxNumThreads]
+		starts and stops the threads and rewrites numThreads, which run reads.
+		so it must never overlap run: only call it from prepareToPlay
+		or while processing is suspended.
+		*/
+		void prepare(int);
+
+		int getNumThreads() const noexcept;
+
+		/* task, context, numTasks. returns once all tasks are done */
+		void run(Task, void*, int) noexcept;
+
+	protected:
+		std::array<std::unique_ptr<Worker>, MaxNumThreads> workers;
+		int numThreads;
+
+		Task task;
+		void* context;
+		// numTasks in the upper, the next task's index in the lower 32 bits
+		std::atomic<unsigned long long> ticket;
+		std::atomic<int> numDone;
+		std::atomic<unsigned int> generation;
+		std::atomic<bool> exiting;
+
+		void work() noexcept;
+
+		void stop();
+	};
+}
@@ -62,6 +62,16 @@ namespace audio
 		return xen;
 	}
 
+	float XenManager::getMasterTune() const noexcept
+	{
+		return masterTune;
+	}
+
+	float XenManager::getBaseNote() const noexcept
+	{
+		return baseNote;
+	}
+
 	template float XenManager::noteToFreqHz<float>(float note) const noexcept;
 	template double XenManager::noteToFreqHz<double>(double note) const noexcept;
 
@@ -118,8 +128,9 @@ namespace audio
 			const auto freqHz = xen.noteToFreqHzWithWrap(pitch.load());
 			osc.setFreqHz(freqHz);
 
+			osc(buf, numSamples);
 			for (auto s = 0; s < numSamples; ++s)
-				buf[s] = std::tanh(4.f * osc()) * g;
+				buf[s] = std::tanh(4.f * buf[s]) * g;
 
 			for (auto ch = 0; ch < numChannels; ++ch)
 				SIMD::add(samples[ch], buf, numSamples);
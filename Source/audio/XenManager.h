@@ -27,6 +27,10 @@ namespace audio
 		
 		float getXen() const noexcept;
 
+		float getMasterTune() const noexcept;
+
+		float getBaseNote() const noexcept;
+
 	protected:
 		float xen, masterTune, baseNote;
 		std::array<std::atomic<float>, PPD_MaxXen + 1> temperaments;
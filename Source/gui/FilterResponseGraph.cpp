@@ -1,5 +1,4 @@
 #include "FilterResponseGraph.h"
-#include "../arch/Interpolation.h"
 
 namespace gui
 {
@@ -8,18 +7,16 @@ namespace gui
 	FilterResponseGraph::FilterResponseGraph(Utils& u) :
 		Comp(u, "", CursorType::Default),
 		responseCurveCID(ColourID::Hover),
-		processFilters(nullptr),
+		processResponse(nullptr),
 		needsUpdate(nullptr),
 
-		impulse(),
-		processBuffer(),
-		dftBuffer(),
+		responseTable(),
+		scaledFreqs(),
+		gains(),
 
-		responseCurve()
+		responseCurve(),
+		tableXen(0.f), tableMasterTune(0.f), tableBaseNote(0.f), tableFs(0.f)
 	{
-		SIMD::clear(impulse.data(), Size);
-		impulse[0] = 1.f;
-
 		setInterceptsMouseClicks(false, false);
 		startTimerHz(4);
 	}
@@ -37,7 +34,7 @@ namespace gui
 
 	void FilterResponseGraph::resized()
 	{
-		if (responseCurve.isEmpty())
+		if (!processResponse)
 			return;
 
 		updateResponseCurve();
@@ -45,122 +42,76 @@ namespace gui
 
 	void FilterResponseGraph::timerCallback()
 	{
-		if (needsUpdate())
+		if (!processResponse)
+			return;
+
+		const auto axisChanged = updateResponseTable();
+		if ((needsUpdate && needsUpdate()) || axisChanged)
 		{
-			updateResponseCurve();
+			generateResponseCurve();
 			repaint();
 		}
 	}
 
 	void FilterResponseGraph::updateResponseCurve()
 	{
-		resetBuffers();
-
-		processFilters(processBuffer.data(), impulse, Size);
-
-		applyForwardDFT();
-
+		updateResponseTable();
 		generateResponseCurve();
 	}
 
-	void FilterResponseGraph::resetBuffers()
-	{
-		SIMD::clear(processBuffer.data(), processBuffer.size());
-
-		for (auto& d : dftBuffer)
-			d = { 0.f, 0.f };
-	}
-
-	void FilterResponseGraph::applyForwardDFT()
+	bool FilterResponseGraph::updateResponseTable()
 	{
-		auto buf = processBuffer.data();
-		auto dft = dftBuffer.data();
-
-		for (auto n = 0; n < Size; ++n)
+		const auto numFreqs = std::max(getWidth(), 2);
+		const auto& xen = utils.audioProcessor.xenManager;
+		const auto Fs = static_cast<float>(utils.audioProcessor.getSampleRate());
+
+		// the pitch axis only depends on these, so the pows and trig only run when one moves
+		if (static_cast<int>(scaledFreqs.size()) == numFreqs &&
+			tableXen == xen.getXen() &&
+			tableMasterTune == xen.getMasterTune() &&
+			tableBaseNote == xen.getBaseNote() &&
+			tableFs == Fs)
+			return false;
+
+		tableXen = xen.getXen();
+		tableMasterTune = xen.getMasterTune();
+		tableBaseNote = xen.getBaseNote();
+		tableFs = Fs;
+
+		const auto wInv = 1.f / static_cast<float>(numFreqs - 1);
+		const auto fsInv = 1.f / Fs;
+		scaledFreqs.resize(numFreqs);
+		for (auto x = 0; x < numFreqs; ++x)
 		{
-			const auto f = Pi * static_cast<float>(n) * SizeInv;
-			auto real = 0.f;
-			auto imag = 0.f;
-			for (auto s = 0; s < Size; ++s)
-			{
-				const auto sf = s * f;
-				real += buf[s] * std::cos(sf);
-				imag -= buf[s] * std::sin(sf);
-			}
-			dft[n] += std::complex<float>{ real, imag };
+			const auto pitch = static_cast<float>(x) * wInv * 128.f;
+			const auto freqHz = xen.noteToFreqHzWithWrap(pitch + tableXen);
+			scaledFreqs[x] = std::min(freqHz * fsInv, .5f);
 		}
 
-		for (auto i = 0; i < Size; ++i)
-			buf[i] = std::abs(dft[i]);
+		responseTable.prepare(scaledFreqs.data(), numFreqs);
+		gains.resize(numFreqs);
+		return true;
 	}
 
 	void FilterResponseGraph::generateResponseCurve()
 	{
-		const auto thicc = utils.thicc;
 		const auto w = static_cast<float>(getWidth());
 		const auto h = static_cast<float>(getHeight());
-		const auto wInv = 1.f / w;
-		const auto buf = processBuffer.data();
-		const auto& xen = utils.audioProcessor.xenManager;
-		const auto fsInv = 1.f / static_cast<float>(utils.audioProcessor.getSampleRate());
+		const auto numFreqs = responseTable.size();
 
+		SIMD::fill(gains.data(), 1.f, numFreqs);
+		processResponse(gains.data(), responseTable);
+
+		const auto xInc = w / static_cast<float>(numFreqs - 1);
 		responseCurve.clear();
+		for (auto i = 0; i < numFreqs; ++i)
 		{
-			const auto y = h - h * buf[0];
-			responseCurve.startNewSubPath(0.f, y);
+			const auto x = static_cast<float>(i) * xInc;
+			const auto y = juce::jlimit(0.f, h, h - h * gains[i]);
+			if (i == 0)
+				responseCurve.startNewSubPath(x, y);
+			else
+				responseCurve.lineTo(x, y);
 		}
-		for (auto x = thicc; x < w; x += 1.f)
-		{
-			const auto r = x * wInv;
-			const auto pitch = r * 128.f;
-			const auto freqHz = xen.noteToFreqHzWithWrap(pitch + xen.getXen());
-			const auto fc = freqHz * fsInv;
-			const auto idx = fc * SizeF;
-
-			auto y = h - h * interpolate::lerp(buf, idx);
-			y = juce::jlimit(0.f, h, y);
-
-			responseCurve.lineTo(x, y);
-		}
-		responseCurve.lineTo(w, h - h * buf[Size - 1]);
-	}
-
-	//FilterResponseGraph2
-
-	FilterResponseGraph2::FilterResponseGraph2(Utils& u) :
-		Comp(u, "", CursorType::Default),
-		responseCurveCID(ColourID::Hover),
-		shallUpdate(),
-		update(),
-		responseCurve()
-	{
-		setInterceptsMouseClicks(false, false);
-		startTimerHz(PPDFPSKnobs);
-	}
-
-	void FilterResponseGraph2::paint(Graphics& g)
-	{
-		if (responseCurve.isEmpty())
-			return;
-		const auto thicc = utils.thicc;
-		const Stroke stroke(thicc, Stroke::PathStrokeType::JointStyle::curved, Stroke::PathStrokeType::EndCapStyle::rounded);
-
-		g.setColour(Colours::c(responseCurveCID));
-		g.strokePath(responseCurve, stroke);
-	}
-
-	void FilterResponseGraph2::timerCallback()
-	{
-		if (shallUpdate())
-			resized();
-	}
-
-	void FilterResponseGraph2::resized()
-	{
-		const auto w = static_cast<float>(getWidth());
-		const auto h = static_cast<float>(getHeight());
-
-		update(responseCurve, w, h);
-		repaint();
 	}
-}
\ No newline at end of file
+}
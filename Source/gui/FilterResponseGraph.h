@@ -1,29 +1,21 @@
 #pragma once
 #include "Comp.h"
 #include <functional>
-#include <array>
-#include <complex>
+#include <vector>
 #include "../audio/XenManager.h"
+#include "../audio/Filter.h"
 
 namespace gui
 {
+	/*
+	* magnitude response of filters over the pitch axis.
+	the z-table is only rebuilt when the width, tuning or Fs change,
+	so an update is one batched evaluation per pixel column.
+	*/
 	struct FilterResponseGraph :
 		public Comp,
 		public Timer
 	{
-		using Complex = std::complex<float>;
-		
-#if JUCE_DEBUG
-		static constexpr int Size = 1 << 10;
-#else
-		static constexpr int Size = 1 << 12;
-#endif
-		static constexpr float SizeF = static_cast<float>(Size);
-		static constexpr float SizeInv = 1.f / SizeF;
-
-		using Buffer = std::array<float, Size>;
-		using DFTBuffer = std::array<Complex, Size>;
-
 		FilterResponseGraph(Utils&);
 
 		void paint(Graphics&) override;
@@ -35,41 +27,20 @@ namespace gui
 		void updateResponseCurve();
 
 		ColourID responseCurveCID;
-		/* samples, impulse, numSamples */
-		std::function<void(float*, Buffer&, int)> processFilters;
+		/* gains, table
+		gains start at 1, one per pixel column. takes IIR::responseGain,
+		FilterBandpassSlope::responseGain or several multiplyResponse calls */
+		std::function<void(float*, const audio::ResponseTable&)> processResponse;
 		std::function<bool()> needsUpdate;
 	protected:
-		Buffer impulse;
-		Buffer processBuffer;
-		DFTBuffer dftBuffer;
-
+		audio::ResponseTable responseTable;
+		std::vector<float> scaledFreqs, gains;
 		Path responseCurve;
+		float tableXen, tableMasterTune, tableBaseNote, tableFs;
 
-		void resetBuffers();
-		
-		void applyForwardDFT();
+		/* returns true if the pitch axis changed */
+		bool updateResponseTable();
 
 		void generateResponseCurve();
-
-	};
-
-	struct FilterResponseGraph2 :
-		public Comp,
-		public Timer
-	{
-		FilterResponseGraph2(Utils&);
-
-		void paint(Graphics&) override;
-
-		void timerCallback();
-
-		void resized() override;
-
-		ColourID responseCurveCID;
-		std::function<bool()> shallUpdate;
-		/* responseCurve, width, height */
-		std::function<void(Path&, float, float)> update;
-	protected:
-		Path responseCurve;
 	};
-}
\ No newline at end of file
+}
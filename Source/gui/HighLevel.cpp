@@ -330,6 +330,12 @@ namespace gui
 		buttonsBottom.push_back(std::make_unique<Button>(u, param::toTooltip(PID::HQ)));
 		makeParameter(*buttonsBottom.back(), PID::HQ, "HQ", true);
 		buttonsBottom.back()->getLabel().mode = Label::Mode::TextToLabelBounds;
+		buttonsBottom.push_back(std::make_unique<Button>(u, param::toTooltip(PID::HQFactor)));
+		makeParameter(*buttonsBottom.back(), PID::HQFactor, "");
+		buttonsBottom.back()->getLabel().mode = Label::Mode::TextToLabelBounds;
+		buttonsBottom.push_back(std::make_unique<Button>(u, param::toTooltip(PID::HQLowLatency)));
+		makeParameter(*buttonsBottom.back(), PID::HQLowLatency, "Low\nLat", true);
+		buttonsBottom.back()->getLabel().mode = Label::Mode::TextToLabelBounds;
 #endif
 #if PPDHasStereoConfig
 		buttonsBottom.push_back(std::make_unique<Button>(u, param::toTooltip(PID::StereoConfig)));
@@ -916,6 +916,8 @@ namespace gui
 
             if (hasMeter)
             {
+                // drains the frames the audio thread published since the last tick
+                k.utils.audioProcessor.meters.update();
                 const auto metr = std::floor(meter->load() * 128.f) * .0078125f;
                 if (vals[looks::Meter] != metr)
                 {
@@ -22,7 +22,7 @@ namespace gui
 		for (auto v = 0; v < PPD_MIDINumVoices; ++v)
 		{
 			auto& voice = voices[v];
-			auto active = voice.curNote.noteOn;
+			auto active = voice.current.noteOn;
 			if (voicesActive[v] != active)
 			{
 				voicesActive[v] = active;
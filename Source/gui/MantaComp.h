@@ -263,13 +263,16 @@ namespace gui
 
 					{
 						std::vector<float*> tables;
+						std::vector<int> tableIndices;
 						tables.reserve(numSelected);
+						tableIndices.reserve(numSelected);
 						for (auto i = 0; i < numSelected; ++i)
 						{
 							const auto pID = selected[i]->morePIDs[7];
 							const auto tableIdx = pID == PID::Lane1RMDepth ? 0 :
 								pID == PID::Lane2RMDepth ? 1 : 2;
 							tables.emplace_back(u.audioProcessor.manta.getWaveTable(tableIdx).data());
+							tableIndices.emplace_back(tableIdx);
 						}
 						
 						wtParser = std::make_unique<FormulaParser2>
@@ -282,11 +285,14 @@ namespace gui
 						);
 						
 						auto oR = wtParser->parser.onReturn;
-						wtParser->parser.onReturn = [&, oR]()
+						wtParser->parser.onReturn = [&, oR, tableIndices]()
 						{
 							if (!oR())
 								return false;
 
+							for (auto tableIdx : tableIndices)
+								u.audioProcessor.manta.getWaveTable(tableIdx).updateMipmaps();
+
 							wtDisplay->repaint();
 							
 							return true;
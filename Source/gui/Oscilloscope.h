@@ -11,10 +11,11 @@ namespace gui
 		using Oscope = audio::Oscilloscope;
 		static constexpr int FPS = 24;
 
-		Oscilloscope(Utils& u, String&& _tooltip, const Oscope& _oscope) :
+		Oscilloscope(Utils& u, String&& _tooltip, Oscope& _oscope) :
 			Comp(u, _tooltip, CursorType::Default),
 			Timer(),
 			oscope(_oscope),
+			window(),
 			curve(),
 			bipolar(true)
 		{
@@ -38,8 +39,11 @@ namespace gui
 			g.setColour(Colours::c(ColourID::Darken));
 			g.fillRoundedRectangle(bounds, thicc);
 			
-			const auto data = oscope.data();
-			const auto size = oscope.windowLength();
+			if (window.empty())
+				return;
+
+			const auto data = window.data();
+			const auto size = window.size();
 			const auto sizeF = static_cast<float>(size);
 			const auto beatLength = oscope.getBeatLength();
 			const auto w = bounds.getWidth();
@@ -57,7 +61,7 @@ namespace gui
 			for (auto i = 1.f; i <= w; ++i)
 			{
 				const auto x = xOff + i;
-				const auto idx = static_cast<int>(i * xScaleInv);
+				const auto idx = std::min(static_cast<int>(i * xScaleInv), static_cast<int>(size) - 1);
 				y = yOff - data[idx] * yScale;
 				curve.lineTo(x, y);
 			}
@@ -68,11 +72,28 @@ namespace gui
 
 		void timerCallback() override
 		{
+			const auto size = static_cast<size_t>(oscope.windowLength());
+			if (window.size() != size)
+				window.assign(size, 0.f);
+
+			auto& chunks = oscope.getChunks();
+			while (const auto chunk = chunks.front())
+			{
+				const auto start = static_cast<size_t>(chunk->startIdx);
+				if (start < size)
+				{
+					const auto n = std::min(static_cast<size_t>(chunk->numSamples), size - start);
+					std::copy(chunk->samples.begin(), chunk->samples.begin() + n, window.begin() + start);
+				}
+				chunks.pop();
+			}
+
 			repaint();
 		}
 
 	protected:
-		const Oscope& oscope;
+		Oscope& oscope;
+		std::vector<float> window;
 		BoundsF bounds;
 		Path curve;
 	public:
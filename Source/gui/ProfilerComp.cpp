@@ -0,0 +1,41 @@
+#include "ProfilerComp.h"
+
+#if PPDHasProfiler
+namespace gui
+{
+	ProfilerComp::ProfilerComp(Utils& u) :
+		Comp(u, "Per stage timings of the audio thread. Click to write them to a file.", CursorType::Interact),
+		text()
+	{
+		setInterceptsMouseClicks(true, false);
+		startTimerHz(4);
+	}
+
+	void ProfilerComp::paint(Graphics& g)
+	{
+		const auto thicc = utils.thicc;
+		const auto bounds = getLocalBounds().toFloat().reduced(thicc);
+
+		g.setColour(Colours::c(ColourID::Bg).withAlpha(.8f));
+		g.fillRoundedRectangle(bounds, thicc);
+
+		g.setColour(Colours::c(ColourID::Hover));
+		g.setFont(getFontDosisMedium());
+		g.drawFittedText(text, bounds.reduced(thicc).toNearestInt(), Just::topLeft, 32, 1.f);
+	}
+
+	void ProfilerComp::mouseUp(const Mouse&)
+	{
+		if (!utils.audioProcessor.dumpProfile())
+			return;
+		const String toastStr("profile.txt written.");
+		notify(EvtType::Toast, &toastStr);
+	}
+
+	void ProfilerComp::timerCallback()
+	{
+		text = utils.audioProcessor.profiler.toString();
+		repaint();
+	}
+}
+#endif
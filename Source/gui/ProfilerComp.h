@@ -0,0 +1,27 @@
+#pragma once
+#include "Comp.h"
+
+#if PPDHasProfiler
+namespace gui
+{
+	/*
+	* shows the processor's per stage timings.
+	click to write them to profile.txt next to the settings file.
+	*/
+	struct ProfilerComp :
+		public Comp,
+		public Timer
+	{
+		ProfilerComp(Utils&);
+
+	protected:
+		String text;
+
+		void paint(Graphics&) override;
+
+		void mouseUp(const Mouse&) override;
+
+		void timerCallback() override;
+	};
+}
+#endif
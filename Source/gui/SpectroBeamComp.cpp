@@ -25,15 +25,15 @@ namespace gui
 	template<size_t Order>
 	void SpectroBeamComp<Order>::timerCallback()
 	{
-		auto ready = beam.ready.load();
-		if (!ready)
+		const auto frame = beam.frames.back();
+		if (frame == nullptr)
 			return;
 
 		const auto Fs = static_cast<float>(utils.audioProcessor.getSampleRate());
 		const auto fsInv = 1.f / Fs;
 		const auto colBase = Colours::c(ColourID::Bg);
 		const auto col = Colours::c(mainColCID);
-		const auto buf = beam.buffer.data();
+		const auto buf = frame->data();
 
 		const auto lowestDb = -12.f;
 		const auto highestDb = 6.f;
@@ -54,7 +54,7 @@ namespace gui
 			img.setPixelAt(x, 0, nCol);
 		}
 
-		beam.ready.store(false);
+		beam.frames.pop();
 		repaint();
 	}
 
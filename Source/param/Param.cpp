@@ -1,6 +1,8 @@
 #include "Param.h"
 #include "../arch/FormulaParser2.h"
 #include "../arch/Conversion.h"
+#include "../arch/Tripwire.h"
+#include <bit>
 
 namespace param
 {
@@ -40,6 +42,8 @@ namespace param
 #endif
 #if PPDHasHQ
 		case PID::HQ: return "HQ";
+		case PID::HQFactor: return "HQ Factor";
+		case PID::HQLowLatency: return "HQ Low Latency";
 #endif
 #if PPDHasGainOut
 		case PID::Gain: return "Gain Out";
@@ -120,7 +124,9 @@ namespace param
 		case PID::MuteDry: return "Mute the dry signal.";
 #endif
 #if PPDHasHQ
-		case PID::HQ: return "Turn on HQ to apply 2x Oversampling to the signal.";
+		case PID::HQ: return "Turn on HQ to apply Oversampling to the signal.";
+		case PID::HQFactor: return "Choose how many times the signal gets oversampled when HQ is on.";
+		case PID::HQLowLatency: return "Use low latency IIR filters for HQ. Great for tracking, but the phase response is not linear, so dry and wet don't line up exactly and mixing them causes comb filtering in the highs.";
 #endif
 #if PPDHasGainOut
 		case PID::Gain: return "Apply output gain to the wet signal.";
@@ -186,6 +192,7 @@ namespace param
 		case Unit::Legato: return "";
 		case Unit::Custom: return "";
 		case Unit::FilterType: return "";
+		case Unit::Oversampling: return "x";
 		default: return "";
 		}
 	}
@@ -215,7 +222,10 @@ namespace param
 		locked(false),
 		inGesture(false),
 
-		modDepthLocked(false)
+		modDepthLocked(false),
+
+		dirtyWord(nullptr),
+		dirtyMask(0)
 	{
 	}
 
@@ -292,7 +302,10 @@ namespace param
 			return;
 
 		if (!modDepthLocked)
-			return valNorm.store(normalized);
+		{
+			valNorm.store(normalized);
+			return markDirty();
+		}
 
 		const auto p0 = valNorm.load();
 		const auto p1 = normalized;
@@ -314,6 +327,10 @@ namespace param
 	{
 		if (isInGesture())
 			return;
+#if PPDHasAllocationTripwire
+		// midi learn calls this from processBlock. juce locks the parameter's listeners
+		tripwire::lockTaken();
+#endif
 		beginChangeGesture();
 		setValueNotifyingHost(norm);
 		endChangeGesture();
@@ -342,6 +359,7 @@ namespace param
 			return;
 
 		maxModDepth.store(juce::jlimit(-1.f, 1.f, v));
+		markDirty();
 	}
 
 	float Param::calcValModOf(float macro) const noexcept
@@ -374,6 +392,7 @@ namespace param
 
 		b = juce::jlimit(BiasEps, 1.f - BiasEps, b);
 		modBias.store(b);
+		markDirty();
 	}
 
 	float Param::getModBias() const noexcept
@@ -469,6 +488,18 @@ namespace param
 		return "params/" + toID(toString(pID));
 	}
 
+	void Param::setDirtyFlag(std::atomic<DirtyWord>* word, DirtyWord mask) noexcept
+	{
+		dirtyWord = word;
+		dirtyMask = mask;
+	}
+
+	void Param::markDirty() noexcept
+	{
+		if (dirtyWord != nullptr)
+			dirtyWord->fetch_or(dirtyMask, std::memory_order_release);
+	}
+
 	float Param::biased(float start, float end, float bias/*[0,1]*/, float x) const noexcept
 	{
 		const auto r = end - start;
@@ -859,6 +890,16 @@ namespace param::strToVal
 				return p(text, 0.f);
 		};
 	}
+
+	StrToValFunc oversampling()
+	{
+		return[p = parse()](const String& txt)
+		{
+			const auto text = txt.toLowerCase().trimCharactersAtEnd(toString(Unit::Oversampling));
+			const auto factor = p(text, 2.f);
+			return std::round(std::log2(std::max(factor, 2.f)));
+		};
+	}
 }
 
 namespace param::valToStr
@@ -1114,6 +1155,14 @@ namespace param::valToStr
 			}
 		};
 	}
+
+	ValToStrFunc oversampling()
+	{
+		return [](float v)
+		{
+			return String(1 << static_cast<int>(std::round(v))) + "x";
+		};
+	}
 }
 
 namespace param
@@ -1212,6 +1261,10 @@ namespace param
 			valToStrFunc = valToStr::filterType();
 			strToValFunc = strToVal::filterType();
 			break;
+		case Unit::Oversampling:
+			valToStrFunc = valToStr::oversampling();
+			strToValFunc = strToVal::oversampling();
+			break;
 		default:
 			valToStrFunc = [](float v) { return String(v); };
 			strToValFunc = [p = param::strToVal::parse()](const String& s)
@@ -1258,7 +1311,8 @@ namespace param
 	) :
 		params(),
 		state(_state),
-		modDepthLocked(false)
+		modDepthLocked(false),
+		dirty()
 	{
 		{ // HIGH LEVEL PARAMS:
 			const auto gainUnit = PPDGainInDecibels ? Unit::Decibel : Unit::Percent;
@@ -1290,6 +1344,8 @@ namespace param
 #endif
 #if PPDHasHQ
 			params.push_back(makeParam(PID::HQ, state, 0.f, makeRange::toggle()));
+			params.push_back(makeParam(PID::HQFactor, state, 1.f, makeRange::stepped(1.f, 4.f), Unit::Oversampling));
+			params.push_back(makeParam(PID::HQLowLatency, state, 0.f, makeRange::toggle(), Unit::Power));
 #endif
 #if PPDHasStereoConfig
 			params.push_back(makeParam(PID::StereoConfig, state, 1.f, makeRange::toggle(), Unit::StereoConfig));
@@ -1318,8 +1374,15 @@ namespace param
 		params.push_back(makeParam(PID::FilterSmoothUpsampler, state, 0.f, makeRange::stepped(0.f, 12.f), Unit::Custom));
 		// LOW LEVEL PARAMS END
 
+		for (auto& d : dirty)
+			d.store(0);
+
 		for (auto param : params)
+		{
+			const auto i = static_cast<int>(param->id);
+			param->setDirtyFlag(&dirty[i / 64], static_cast<DirtyWord>(1) << (i % 64));
 			audioProcessor.addParameter(param);
+		}
 	}
 
 	void Params::loadPatch(juce::ApplicationProperties& appProps)
@@ -1369,6 +1432,11 @@ namespace param
 
 	const Params::Parameters& Params::data() const noexcept { return params; }
 
+	DirtyWord Params::consumeDirty(int word) noexcept
+	{
+		return dirty[word].exchange(0, std::memory_order_acquire);
+	}
+
 	bool Params::isModDepthLocked() const noexcept { return modDepthLocked.load(); }
 
 	void Params::setModDepthLocked(bool e) noexcept
@@ -1383,17 +1451,69 @@ namespace param
 		setModDepthLocked(!isModDepthLocked());
 	}
 
+	// PARAM SNAPSHOT
+
+	ParamSnapshot::ParamSnapshot() :
+		valNorm(),
+		valDenorm()
+	{
+		valNorm.fill(0.f);
+		valDenorm.fill(0.f);
+	}
+
+	float ParamSnapshot::norm(PID pID) const noexcept
+	{
+		return valNorm[static_cast<int>(pID)];
+	}
+
+	float ParamSnapshot::operator[](PID pID) const noexcept
+	{
+		return valDenorm[static_cast<int>(pID)];
+	}
+
 	// MACRO PROCESSOR
 
 	MacroProcessor::MacroProcessor(Params& _params) :
-		params(_params)
+		params(_params),
+		snapshot(),
+		modulated(),
+		macro(params[PID::Macro]->getValue())
 	{
+		modulated.fill(0);
+		for (auto i = 0; i < NumParams; ++i)
+			update(i);
 	}
 
 	void MacroProcessor::operator()() noexcept
 	{
-		const auto modDepth = params[PID::Macro]->getValue();
-		for (auto i = 1; i < NumParams; ++i)
-			params[i]->modulate(modDepth);
+		const auto macroNow = params[PID::Macro]->getValue();
+		const auto macroMoved = macroNow != macro;
+		macro = macroNow;
+
+		for (auto w = 0; w < NumDirtyWords; ++w)
+		{
+			auto bits = params.consumeDirty(w);
+			if (macroMoved)
+				bits |= modulated[w];
+
+			while (bits != 0)
+			{
+				update(w * 64 + std::countr_zero(bits));
+				bits &= bits - 1;
+			}
+		}
+	}
+
+	void MacroProcessor::update(int i) noexcept
+	{
+		auto param = params[i];
+		param->modulate(macro);
+		const auto norm = param->getValMod();
+		snapshot.valNorm[i] = norm;
+		snapshot.valDenorm[i] = param->range.convertFrom0to1(norm);
+
+		const auto mask = static_cast<DirtyWord>(1) << (i % 64);
+		auto& word = modulated[i / 64];
+		word = param->getMaxModDepth() != 0.f ? word | mask : word & ~mask;
 	}
 }
\ No newline at end of file
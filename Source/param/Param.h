@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <array>
+#include <cstdint>
 
 #include "juce_core/juce_core.h"
 #include "juce_audio_processors/juce_audio_processors.h"
@@ -40,6 +42,8 @@ namespace param
 #endif
 #if PPDHasHQ
 		HQ,
+		HQFactor,
+		HQLowLatency,
 #endif
 #if PPDHasStereoConfig
 		StereoConfig,
@@ -115,6 +119,7 @@ namespace param
 		Legato,
 		Custom,
 		FilterType,
+		Oversampling,
 		NumUnits
 	};
 
@@ -131,6 +136,10 @@ namespace param
 	using State = sta::State;
 	using Xen = audio::XenManager&;
 
+	// one bit per parameter, set when its value, depth or bias changed
+	using DirtyWord = std::uint64_t;
+	static constexpr int NumDirtyWords = (NumParams + 63) / 64;
+
 	class Param :
 		public ParameterBase
 	{
@@ -211,6 +220,9 @@ namespace param
 
 		static String getIDString(PID);
 
+		/* dirtyWord, dirtyMask */
+		void setDirtyFlag(std::atomic<DirtyWord>*, DirtyWord) noexcept;
+
 		const PID id;
 		const Range range;
 	protected:
@@ -224,6 +236,11 @@ namespace param
 		std::atomic<bool> locked, inGesture;
 
 		bool modDepthLocked;
+
+		std::atomic<DirtyWord>* dirtyWord;
+		DirtyWord dirtyMask;
+
+		void markDirty() noexcept;
 	};
 
 	struct Params
@@ -258,11 +275,15 @@ namespace param
 
 		Parameters& data() noexcept;
 		const Parameters& data() const noexcept;
+
+		/* word, returns and clears the parameters that changed since the last call */
+		DirtyWord consumeDirty(int) noexcept;
 	protected:
 		Parameters params;
 
 		State& state;
 		std::atomic<float> modDepthLocked;
+		std::array<std::atomic<DirtyWord>, NumDirtyWords> dirty;
 	};
 
 	namespace strToVal
@@ -293,6 +314,7 @@ namespace param
 		StrToValFunc beats();
 		StrToValFunc legato();
 		StrToValFunc filterType();
+		StrToValFunc oversampling();
 	}
 
 	namespace valToStr
@@ -323,8 +345,31 @@ namespace param
 		ValToStrFunc beats();
 		ValToStrFunc legato();
 		ValToStrFunc filterType();
+		ValToStrFunc oversampling();
 	}
 
+	/*
+	* modulated values of all parameters for the current block.
+	contiguous plain floats, so dsp code doesn't touch atomics or ranges.
+	*/
+	struct ParamSnapshot
+	{
+		ParamSnapshot();
+
+		/* pID, normalized */
+		float norm(PID) const noexcept;
+
+		/* pID, denormalized */
+		float operator[](PID) const noexcept;
+
+		std::array<float, NumParams> valNorm, valDenorm;
+	};
+
+	/*
+	* applies the macro to the parameters once per block.
+	only parameters that changed, or that are modulated while the macro
+	moved, are recalculated into the snapshot.
+	*/
 	struct MacroProcessor
 	{
 		MacroProcessor(Params&);
@@ -332,6 +377,13 @@ namespace param
 		void operator()() noexcept;
 
 		Params& params;
+		ParamSnapshot snapshot;
+	protected:
+		std::array<DirtyWord, NumDirtyWords> modulated;
+		float macro;
+
+		/* parameter index */
+		void update(int) noexcept;
 	};
 	
 }
\ No newline at end of file